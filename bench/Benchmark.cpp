@@ -0,0 +1,57 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "SourceGenerator.hpp"
+
+llvm::cl::OptionCategory BenchmarkCategory("benchmark options");
+
+static llvm::cl::opt<std::string> InputFilename(llvm::cl::Positional, llvm::cl::Optional,
+                                                llvm::cl::desc("[<path to file>]"), llvm::cl::cat(BenchmarkCategory));
+// the description and default are the benchmark's (see ParseBenchmarkCommandLine)
+static llvm::cl::opt<unsigned> Iterations("iterations", llvm::cl::cat(BenchmarkCategory));
+
+void ParseBenchmarkCommandLine(int argc, char **argv, const char *Overview, unsigned DefaultIterations) {
+    // the option keeps a reference to its description
+    static std::string IterationsDesc =
+            "how many times to repeat the measurement (default: " + std::to_string(DefaultIterations) + ")";
+    Iterations.setDescription(IterationsDesc);
+    Iterations.setInitialValue(DefaultIterations);
+    llvm::cl::HideUnrelatedOptions({&BenchmarkCategory, &SourceShapeCategory});
+    llvm::cl::ParseCommandLineOptions(argc, argv, Overview);
+}
+
+std::string GetBenchmarkSource() {
+    if (InputFilename.empty())
+        return GenerateSource(GetCommandLineShape());
+
+    auto FileOrErr = llvm::MemoryBuffer::getFile(InputFilename);
+    if (!FileOrErr) {
+        std::cerr << "invalid file: " << FileOrErr.getError().message() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return std::string((*FileOrErr)->getBuffer());
+}
+
+bool HasBenchmarkInputFile() {
+    return !InputFilename.empty();
+}
+
+unsigned GetBenchmarkIterations() {
+    return Iterations;
+}
+
+void PrintThroughput(const char *What, double Seconds, unsigned Iterations, std::uint64_t SourceBytes,
+                     std::uint64_t Functions) {
+    printf("%-10s %10.3f ms/iteration %10.1f MB/s %12.0f functions/s\n", What, Seconds * 1e3 / Iterations,
+           (double)SourceBytes * Iterations / Seconds / 1e6, (double)Functions * Iterations / Seconds);
+}
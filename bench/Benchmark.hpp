@@ -0,0 +1,45 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_BENCHMARK_HPP
+#define ABHEEK_LANG_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <llvm/Support/CommandLine.h>
+
+// options every benchmark takes; a benchmark's own options go here as well
+extern llvm::cl::OptionCategory BenchmarkCategory;
+
+// parses the command line, showing only the benchmark and source shape options
+// in --help; --iterations defaults to DefaultIterations
+void ParseBenchmarkCommandLine(int argc, char **argv, const char *Overview, unsigned DefaultIterations = 10);
+
+// what a benchmark runs on: the file named on the command line or, without one,
+// a program generated to the shape given by the SourceGenerator options
+std::string GetBenchmarkSource();
+// whether a file was named on the command line, for benchmarks whose default
+// input isn't a generated program
+bool HasBenchmarkInputFile();
+// --iterations
+unsigned GetBenchmarkIterations();
+
+// prints one line of results: time per iteration, source MB/s and functions/s
+void PrintThroughput(const char *What, double Seconds, unsigned Iterations, std::uint64_t SourceBytes,
+                     std::uint64_t Functions);
+
+class Stopwatch {
+public:
+    double getSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+};
+
+
+#endif //ABHEEK_LANG_BENCHMARK_HPP
@@ -0,0 +1,75 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+// codegen and emission benchmark: compiles the same source to an object file
+// repeatedly and reports IR generation, optimization and emission separately,
+// as timed by CompileStats (see --time-report)
+//
+// usage: codegen_bench [path to file] [--iterations N] [--opt-level 0-3] [shape options]
+// without a path a generated program is compiled (see SourceGenerator.hpp)
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <llvm/Support/FileSystem.h>
+
+#include "Benchmark.hpp"
+#include "Compiler/CompileStats.hpp"
+#include "Compiler/CompilerInstance.hpp"
+
+static llvm::cl::opt<unsigned> OptLevel("opt-level", llvm::cl::desc("optimization level (0-3)"), llvm::cl::init(0),
+                                       llvm::cl::cat(BenchmarkCategory));
+
+static llvm::OptimizationLevel GetOptimizationLevel() {
+    switch (OptLevel) {
+        case 0: return llvm::OptimizationLevel::O0;
+        case 1: return llvm::OptimizationLevel::O1;
+        case 2: return llvm::OptimizationLevel::O2;
+        default: return llvm::OptimizationLevel::O3;
+    }
+}
+
+int main(int argc, char **argv) {
+    ParseBenchmarkCommandLine(argc, argv, "abheek_lang codegen benchmark\n");
+    std::string Source = GetBenchmarkSource();
+    unsigned Iterations = GetBenchmarkIterations();
+
+    CompilerOptions Options;
+    Options.OptLevel = GetOptimizationLevel();
+
+    // a real file: writing to /dev/null wouldn't count the bytes emitted
+    llvm::SmallString<128> ObjectPath;
+    if (std::error_code EC = llvm::sys::fs::createTemporaryFile("codegen_bench", "o", ObjectPath)) {
+        std::cerr << "can't create a temporary file: " << EC.message() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // one set of stats across every iteration, so the phase times add up
+    CompileStats Stats;
+    for (unsigned i = 0; i < Iterations; i++) {
+        CompilerInstance CI(Source, "codegen_bench", Options);
+        CI.Stats = &Stats;
+        CI.Lex.Tokenize();
+        if (CI.InitializeModule()) {
+            std::cerr << "failed to set up the target" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        CI.MainLoop();
+        CI.OptimizeModule();
+        if (CI.SaveObjectToFile(std::string(ObjectPath)))
+            exit(EXIT_FAILURE);
+    }
+    llvm::sys::fs::remove(ObjectPath);
+
+    std::uint64_t Functions = Stats.Functions.size() / Iterations;
+    PrintThroughput("sema", Stats.Seconds[CompileStats::Sema], Iterations, Source.size(), Functions);
+    PrintThroughput("codegen", Stats.Seconds[CompileStats::Codegen] + Stats.Seconds[CompileStats::Verify],
+                    Iterations, Source.size(), Functions);
+    if (Options.OptLevel != llvm::OptimizationLevel::O0)
+        PrintThroughput("optimize", Stats.Seconds[CompileStats::Optimize], Iterations, Source.size(), Functions);
+    PrintThroughput("emit", Stats.Seconds[CompileStats::Emit], Iterations, Source.size(), Functions);
+    printf("%llu object bytes per iteration\n", (unsigned long long)Stats.BytesEmitted / Iterations);
+}
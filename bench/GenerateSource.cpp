@@ -0,0 +1,33 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+// writes a generated benchmark program, e.g. to look at or to compile with the
+// real driver (--time-report, --trace)
+//
+// usage: generate_source [shape options] [-o path]
+
+#include <cstdlib>
+#include <iostream>
+
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "SourceGenerator.hpp"
+
+static llvm::cl::opt<std::string> OutputFilename("o", llvm::cl::desc("file to write (default: standard output)"),
+                                                 llvm::cl::value_desc("path"), llvm::cl::init("-"),
+                                                 llvm::cl::cat(SourceShapeCategory));
+
+int main(int argc, char **argv) {
+    llvm::cl::HideUnrelatedOptions(SourceShapeCategory);
+    llvm::cl::ParseCommandLineOptions(argc, argv, "abheek_lang benchmark source generator\n");
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(OutputFilename, EC);
+    if (EC) {
+        std::cerr << OutputFilename << ": " << EC.message() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    OS << GenerateSource(GetCommandLineShape());
+}
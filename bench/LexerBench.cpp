@@ -0,0 +1,40 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+// lexer microbenchmark: lexes the same buffer repeatedly with Lexer::getTok and
+// reports the cost per token
+//
+// usage: lexer_bench [path to file] [--iterations N] [shape options]
+// without a path a generated program is lexed (see SourceGenerator.hpp)
+
+#include <cstdio>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Token/Token.hpp"
+
+int main(int argc, char **argv) {
+    ParseBenchmarkCommandLine(argc, argv, "abheek_lang lexer benchmark\n");
+    std::string Source = GetBenchmarkSource();
+    unsigned Iterations = GetBenchmarkIterations();
+
+    // std::string keeps the terminating null the lexer relies on
+    std::string_view SourceView(Source);
+
+    long long Tokens = 0, Functions = 0;
+    Stopwatch Timer;
+    for (unsigned i = 0; i < Iterations; i++) {
+        StringInterner Names;
+        Lexer Lex(SourceView, Names);
+        for (Token Tok = Lex.getTok(); Tok.type != Token::type::tok_eof; Tok = Lex.getTok()) {
+            Tokens++;
+            Functions += Tok.type == Token::type::tok_func;
+        }
+    }
+    double Seconds = Timer.getSeconds();
+
+    PrintThroughput("lex", Seconds, Iterations, Source.size(), Functions / Iterations);
+    printf("%lld tokens: %.2f ns/token\n", Tokens / Iterations, Seconds * 1e9 / (double)Tokens);
+}
@@ -0,0 +1,68 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+// parser microbenchmark: lexes once, then parses the same token buffer
+// repeatedly into a fresh ASTContext without generating any code
+//
+// usage: parser_bench [path to file] [--iterations N] [shape options]
+// without a path a generated program is parsed (see SourceGenerator.hpp)
+
+#include <cstdio>
+#include <string>
+
+#include "AST/AST.hpp"
+#include "Benchmark.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Parser/Parser.hpp"
+#include "Token/Token.hpp"
+
+// walks the top level the way CompilerInstance::MainLoop does; returns the number of definitions
+static long long ParseAll(Parser &Parse) {
+    long long Functions = 0;
+    while (true) {
+        switch (Parse.peek().type) {
+            case Token::type::tok_eof:
+                return Functions;
+            case Token::type::tok_func:
+                Parse.ParseFuncDefinition();
+                Functions++;
+                break;
+            case Token::type::tok_extern:
+                Parse.ParseExtern();
+                break;
+            default:
+                if (Parse.peek().value == ";")
+                    Parse.advance();
+                else
+                    Parse.ParseStatement();
+                break;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ParseBenchmarkCommandLine(argc, argv, "abheek_lang parser benchmark\n");
+    std::string Source = GetBenchmarkSource();
+    unsigned Iterations = GetBenchmarkIterations();
+
+    StringInterner Names;
+    Lexer Lex(Source, Names);
+    Lex.Tokenize();
+
+    long long Functions = 0;
+    std::size_t Nodes = 0, Bytes = 0;
+    Stopwatch Timer;
+    for (unsigned i = 0; i < Iterations; i++) {
+        ASTContext AST;
+        Parser Parse(Lex.Tokens, AST);
+        Functions = ParseAll(Parse);
+        Nodes = AST.getNodeCount();
+        Bytes = AST.getBytesAllocated();
+    }
+    double Seconds = Timer.getSeconds();
+
+    PrintThroughput("parse", Seconds, Iterations, Source.size(), Functions);
+    printf("%zu tokens, %zu AST nodes in %zu bytes: %.2f ns/token\n", Lex.Tokens.size(), Nodes, Bytes,
+           Seconds * 1e9 / ((double)Lex.Tokens.size() * Iterations));
+}
@@ -0,0 +1,132 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "SourceGenerator.hpp"
+
+#include <iterator>
+#include <random>
+
+llvm::cl::OptionCategory SourceShapeCategory("generated source options");
+
+static llvm::cl::opt<unsigned> Functions("functions", llvm::cl::desc("number of functions"),
+                                         llvm::cl::init(SourceShape().Functions), llvm::cl::cat(SourceShapeCategory));
+static llvm::cl::opt<unsigned> Statements("statements", llvm::cl::desc("statements per function"),
+                                          llvm::cl::init(SourceShape().StatementsPerFunction),
+                                          llvm::cl::cat(SourceShapeCategory));
+static llvm::cl::opt<unsigned> Depth("depth", llvm::cl::desc("expression nesting depth"),
+                                     llvm::cl::init(SourceShape().ExpressionDepth), llvm::cl::cat(SourceShapeCategory));
+static llvm::cl::opt<unsigned> IdentLength("ident-length", llvm::cl::desc("length of function and argument names"),
+                                           llvm::cl::init(SourceShape().IdentifierLength),
+                                           llvm::cl::cat(SourceShapeCategory));
+static llvm::cl::opt<double> StringDensity("string-density",
+                                           llvm::cl::desc("fraction of statements printing a string literal"),
+                                           llvm::cl::init(SourceShape().StringDensity), llvm::cl::cat(SourceShapeCategory));
+static llvm::cl::opt<unsigned> Seed("seed", llvm::cl::desc("random seed"), llvm::cl::init(SourceShape().Seed),
+                                    llvm::cl::cat(SourceShapeCategory));
+
+SourceShape GetCommandLineShape() {
+    SourceShape Shape;
+    Shape.Functions = Functions;
+    Shape.StatementsPerFunction = Statements;
+    Shape.ExpressionDepth = Depth;
+    Shape.IdentifierLength = IdentLength;
+    Shape.StringDensity = StringDensity;
+    Shape.Seed = Seed;
+    return Shape;
+}
+
+namespace {
+class Generator {
+public:
+    explicit Generator(const SourceShape &Shape) : Shape(Shape), Random(Shape.Seed) {}
+
+    std::string run() {
+        Out += "extern printf(fmt : s1*, ...) : s4;\n\n";
+        for (unsigned i = 0; i < Shape.Functions; i++)
+            function(i);
+
+        // nothing calls the functions: every one calls several earlier ones, so
+        // running them would take exponential time
+        Out += "func main() : s4 {\n  return 0;\n}\n";
+        return std::move(Out);
+    }
+
+private:
+    // Prefix followed by Index, padded with zeros to the requested length
+    std::string name(char Prefix, unsigned Index) {
+        std::string Digits = std::to_string(Index);
+        std::string Name(1, Prefix);
+        if (Digits.size() + 1 < Shape.IdentifierLength)
+            Name.append(Shape.IdentifierLength - Digits.size() - 1, '0');
+        return Name + Digits;
+    }
+
+    unsigned pick(unsigned N) { return std::uniform_int_distribution<unsigned>(0, N - 1)(Random); }
+
+    void function(unsigned Index) {
+        Current = Index;
+        Out += "func " + name('f', Index) + "(" + name('a', Index) + " : s4, " + name('b', Index) +
+               " : s4) : s4 {\n";
+        std::bernoulli_distribution IsPrint(Shape.StringDensity);
+        for (unsigned i = 0; i < Shape.StatementsPerFunction; i++) {
+            Out += "  ";
+            if (IsPrint(Random)) {
+                Out += "printf(\"" + name('s', pick(1000)) + " %d\\n\", ";
+                expression(Shape.ExpressionDepth);
+                Out += ")";
+            } else {
+                expression(Shape.ExpressionDepth);
+            }
+            Out += ";\n";
+        }
+        Out += "  return ";
+        expression(Shape.ExpressionDepth);
+        Out += ";\n}\n\n";
+    }
+
+    void expression(unsigned Depth) {
+        if (Depth == 0) {
+            leaf();
+            return;
+        }
+        // nothing that could divide by zero or shift too far, and no compares,
+        // whose s1-sized result doesn't mix with other operands
+        static const char *const Ops[] = {"+", "-", "*"};
+        Out += "(";
+        expression(Depth - 1);
+        Out += " ";
+        Out += Ops[pick(std::size(Ops))];
+        Out += " ";
+        expression(Depth - 1);
+        Out += ")";
+    }
+
+    void leaf() {
+        switch (pick(Current > 0 ? 4 : 3)) {
+            case 0:
+                Out += name('a', Current);
+                break;
+            case 1:
+                Out += name('b', Current);
+                break;
+            case 2:
+                Out += std::to_string(pick(100));
+                break;
+            default:
+                // only earlier functions have been declared
+                Out += name('f', pick(Current)) + "(" + name('a', Current) + ", " + name('b', Current) + ")";
+                break;
+        }
+    }
+
+    const SourceShape &Shape;
+    std::mt19937 Random;
+    std::string Out;
+    unsigned Current = 0;
+};
+} // namespace
+
+std::string GenerateSource(const SourceShape &Shape) {
+    return Generator(Shape).run();
+}
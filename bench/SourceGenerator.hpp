@@ -0,0 +1,38 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_SOURCEGENERATOR_HPP
+#define ABHEEK_LANG_SOURCEGENERATOR_HPP
+
+#include <string>
+
+#include <llvm/Support/CommandLine.h>
+
+// the shape of a generated benchmark program
+struct SourceShape {
+    unsigned Functions = 2000;
+    // statements before the closing return of every function
+    unsigned StatementsPerFunction = 8;
+    // nesting depth of the binary expressions (a leaf is depth 0)
+    unsigned ExpressionDepth = 3;
+    // length of every function and argument name
+    unsigned IdentifierLength = 8;
+    // fraction of statements that are printf calls with a string literal
+    double StringDensity = 0.1;
+    unsigned Seed = 1;
+};
+
+// a valid .ad program of the given shape: an extern printf, functions that each
+// call earlier ones, and an empty main. the same shape always generates the same program
+std::string GenerateSource(const SourceShape &Shape);
+
+// the options below, shown next to a tool's own
+extern llvm::cl::OptionCategory SourceShapeCategory;
+
+// the shape set by the --functions, --statements, --depth, --ident-length,
+// --string-density and --seed options of whichever tool links this in
+SourceShape GetCommandLineShape();
+
+
+#endif //ABHEEK_LANG_SOURCEGENERATOR_HPP
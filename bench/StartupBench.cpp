@@ -0,0 +1,69 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+// startup microbenchmark: compiles a hello-world-sized source to an object file
+// repeatedly in one process. the first compile pays for target registration and
+// TargetMachine setup; the rest show what every later compile costs.
+//
+// usage: startup_bench [path to file] [--iterations N] [--generated [shape options]]
+// without a path the compiler's own helloworld.ad is compiled from memory, or
+// with --generated a generated program (see SourceGenerator.hpp)
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "Compiler/CompilerInstance.hpp"
+
+static llvm::cl::opt<bool> Generated("generated",
+                                     llvm::cl::desc("without a file, compile a generated program instead of hello "
+                                                    "world"),
+                                     llvm::cl::cat(BenchmarkCategory));
+
+static const char *HelloWorld =
+        "extern printf(fmt : s1*, ...) : s4;\n"
+        "\n"
+        "func helloWorld(name : s1*) : void {\n"
+        "  printf(\"hello %s!\\n\", name);\n"
+        "}\n"
+        "\n"
+        "func main() : s4 {\n"
+        "  helloWorld(\"world\");\n"
+        "  return 0;\n"
+        "}\n";
+
+// one full compile, from lexing to the emitted object; returns seconds taken
+static double Compile(std::string_view Source) {
+    Stopwatch Timer;
+    CompilerInstance CI(Source, "startup_bench");
+    CI.Lex.Tokenize();
+    if (CI.InitializeModule()) {
+        std::cerr << "failed to set up the target" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    CI.MainLoop();
+    CI.OptimizeModule();
+    if (CI.SaveObjectToFile("/dev/null"))
+        exit(EXIT_FAILURE);
+    return Timer.getSeconds();
+}
+
+int main(int argc, char **argv) {
+    ParseBenchmarkCommandLine(argc, argv, "abheek_lang startup benchmark\n", 200);
+    std::string Source = HasBenchmarkInputFile() || Generated ? GetBenchmarkSource() : HelloWorld;
+    unsigned Iterations = GetBenchmarkIterations();
+
+    // std::string keeps the terminating null the lexer relies on
+    std::string_view SourceView(Source);
+
+    double First = Compile(SourceView);
+    double Rest = 0;
+    for (unsigned i = 1; i < Iterations; i++)
+        Rest += Compile(SourceView);
+
+    printf("first compile %.3f ms, then %.3f ms per compile over %u more\n",
+           First * 1e3, Iterations > 1 ? Rest * 1e3 / (Iterations - 1) : 0.0, Iterations > 1 ? Iterations - 1 : 0);
+}
@@ -5,114 +5,219 @@
 #ifndef ABHEEK_LANG_AST_HPP
 #define ABHEEK_LANG_AST_HPP
 
-#include <string>
 #include <memory>
-#include <vector>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/Allocator.h>
 
+#include "AST/Type.hpp"
+#include "Symbol/Symbol.hpp"
 #include "Token/Token.hpp"
 
-int InitializeModule();
-void SaveModuleToFile(const std::string& path);
-int SaveObjectToFile(const std::string &path);
-
-class Type {
-public:
-    inline Type(std::string Name, bool IsPointer) : Name(Name), IsPointer(IsPointer) {}
-
-    llvm::Type *GetLLVMType(llvm::LLVMContext &Ctx) const {
-        if (Name == "s1") {
-            if (IsPointer) return llvm::Type::getInt8PtrTy(Ctx);
-            return llvm::Type::getInt8Ty(Ctx);
-        } else if (Name == "s2") {
-            if (IsPointer) return llvm::Type::getInt16PtrTy(Ctx);
-            return llvm::Type::getInt16Ty(Ctx);
-        } else if (Name == "s4") {
-            if (IsPointer) return llvm::Type::getInt32PtrTy(Ctx);
-            return llvm::Type::getInt32Ty(Ctx);
-        } else if (Name == "s8") {
-            if (IsPointer) return llvm::Type::getInt64PtrTy(Ctx);
-            return llvm::Type::getInt64Ty(Ctx);
-        } else if (Name == "f4") {
-            if (IsPointer) return llvm::Type::getFloatPtrTy(Ctx);
-            return llvm::Type::getFloatTy(Ctx);
-        } else if (Name == "f8") {
-            if (IsPointer) return llvm::Type::getDoublePtrTy(Ctx);
-            return llvm::Type::getDoubleTy(Ctx);
-        } else if (Name == "void") {
-            if (IsPointer) return nullptr;
-            return llvm::Type::getVoidTy(Ctx);
-        } else {
-            return nullptr;
-        }
+class CompilerInstance;
+
+// per-compilation arena that every AST node is allocated from. nodes never own
+// heap memory (names are views into the source and child lists live in the
+// arena as well), so they are never destroyed one by one: the whole tree is
+// released in bulk together with the arena.
+class ASTContext {
+public:
+    template<typename T, typename... Args>
+    T *create(Args &&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "AST nodes are never destroyed");
+        NodeCount++;
+        return new (Allocator.Allocate<T>()) T(std::forward<Args>(args)...);
     }
 
+    // copies a child list built up during parsing into the arena
+    template<typename T>
+    llvm::MutableArrayRef<T> copyArray(llvm::ArrayRef<T> Elements) {
+        static_assert(std::is_trivially_destructible_v<T>, "AST nodes are never destroyed");
+        T *Mem = Allocator.Allocate<T>(Elements.size());
+        std::uninitialized_copy(Elements.begin(), Elements.end(), Mem);
+        return {Mem, Elements.size()};
+    }
+
+    inline std::size_t getBytesAllocated() const { return Allocator.getBytesAllocated(); }
+    inline std::size_t getNodeCount() const { return NodeCount; }
+
+    // the types nodes refer to
+    inline TypeTable &getTypes() { return Types; }
+
 private:
-    std::string Name;
-    bool IsPointer;
+    llvm::BumpPtrAllocator Allocator;
+    std::size_t NodeCount = 0;
+    TypeTable Types;
 };
 
 //----------------------------------------------------------
 // EXPRESSIONS
 //----------------------------------------------------------
 
+// nodes live in an ASTContext and are never deleted, hence no virtual destructors
 class ExprAST {
 public:
-    virtual ~ExprAST();
-    virtual llvm::Value *codegen() = 0;
+    enum class Kind {
+        Number,
+        String,
+        Variable,
+        Binary,
+        Call,
+        Cast,
+        Builtin,
+    };
+
+    explicit ExprAST(Kind K) : K(K) {}
+    virtual llvm::Value *codegen(CompilerInstance &CI) = 0;
+    // appends the name of every function this expression calls
+    virtual void collectCallees(llvm::SmallVectorImpl<Symbol> &) const {}
+
+    inline Kind getKind() const { return K; }
+    // set by semantic analysis (see Sema); codegen produces a value of exactly this type
+    inline const Type &getType() const { return Ty; }
+    inline void setType(const Type &T) { Ty = T; }
+    // the token the expression starts at (a binary expression's operator);
+    // nodes Sema inserts take the position of the one they wrap
+    inline position getLoc() const { return Loc; }
+    inline void setLoc(position P) { Loc = P; }
+
+private:
+    const Kind K;
+    position Loc;
+    Type Ty;
 };
 
 // numeric literal expressions
 class NumberExprAST : public ExprAST {
 public:
-    explicit NumberExprAST(std::string Value);
-    llvm::Value *codegen() override;
+    explicit NumberExprAST(std::string_view Value);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+
+    inline std::string_view getValue() const { return Value; }
+    inline bool isFloatingPoint() const { return Value.find('.') != std::string_view::npos; }
 
 private:
-    std::string Value;
+    std::string_view Value;
 };
 
 // string literal expressions
 class StringExprAST : public ExprAST {
 public:
-    explicit StringExprAST(std::string Value);
-    llvm::Value *codegen() override;
+    explicit StringExprAST(std::string_view Value);
+    llvm::Value *codegen(CompilerInstance &CI) override;
 
 private:
-    std::string Value;
+    std::string_view Value;
 };
 
 class VariableExprAST : public ExprAST {
 public:
-    explicit VariableExprAST(std::string Name);
+    explicit VariableExprAST(Symbol Name);
 
 
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CompilerInstance &CI) override;
+
+    inline Symbol getName() const { return Name; }
 
 private:
-    std::string Name;
+    Symbol Name;
 };
 
 class BinaryExprAST : public ExprAST {
 public:
-    explicit BinaryExprAST(Token  Op, std::unique_ptr<ExprAST> Left, std::unique_ptr<ExprAST> Right);
-    llvm::Value *codegen() override;
+    explicit BinaryExprAST(BinaryOp Op, ExprAST *Left, ExprAST *Right);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+    inline BinaryOp getOp() const { return Op; }
+    // compares produce an s1 holding 1 or 0 instead of a value of the operand
+    // type (an s1 vector of them, lane by lane, for vector operands)
+    static bool isCompare(BinaryOp Op);
+    // false for the operators that only take integers
+    static bool hasFloatingPointForm(BinaryOp Op);
 
 private:
-    Token Op;
-    std::unique_ptr<ExprAST> Left, Right;
+    friend class Sema;
+
+    BinaryOp Op;
+    ExprAST *Left, *Right;
 };
 
 class CallExprAST : public ExprAST {
 public:
-    CallExprAST(std::string Callee, std::vector<std::unique_ptr<ExprAST>> Args);
-    llvm::Value *codegen() override;
+    CallExprAST(Symbol Callee, llvm::MutableArrayRef<ExprAST *> Args);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+    inline Symbol getCallee() const { return Callee; }
+
+private:
+    friend class Sema;
+
+    Symbol Callee;
+    llvm::MutableArrayRef<ExprAST *> Args;
+};
+
+// a call to one of the vector builtins, put in place of the CallExprAST by
+// Sema when no function of that name is declared:
+//   splat(x, lanes)          a vector with x in every lane
+//   extract(v, i)            lane i of v
+//   insert(v, x, i)          v with lane i replaced by x
+//   shuffle(a, b, m...)      lanes picked from a (0..n-1) and b (n..2n-1)
+//   reduceAdd(v), reduceMul(v), reduceMin(v), reduceMax(v)
+//                            all lanes of v combined, in any order
+//   load(p, i), store(p, i, v)     p[i] of a vector pointer p, which has to
+//                                  be aligned to the vector's size
+//   loadu(p, i), storeu(p, i, v)   the same for p only aligned to a lane
+class BuiltinExprAST : public ExprAST {
+public:
+    enum class Builtin {
+        Splat,
+        Extract,
+        Insert,
+        Shuffle,
+        ReduceAdd,
+        ReduceMul,
+        ReduceMin,
+        ReduceMax,
+        Load,
+        LoadUnaligned,
+        Store,
+        StoreUnaligned,
+    };
+
+    // Mask is the lanes a shuffle picks, empty for the others
+    BuiltinExprAST(Builtin Op, llvm::ArrayRef<ExprAST *> Args, llvm::ArrayRef<int> Mask, const Type &T);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+    // the builtin called Name, if there is one
+    static std::optional<Builtin> lookup(llvm::StringRef Name);
 
 private:
-    std::string Callee;
-    std::vector<std::unique_ptr<ExprAST>> Args;
+    Builtin Op;
+    llvm::ArrayRef<ExprAST *> Args;
+    llvm::ArrayRef<int> Mask;
+};
+
+// a conversion between numeric types; never parsed, only inserted by Sema
+// wherever the language converts implicitly
+class CastExprAST : public ExprAST {
+public:
+    CastExprAST(ExprAST *Operand, const Type &To);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+private:
+    ExprAST *Operand;
 };
 
 //----------------------------------------------------------
@@ -121,65 +226,162 @@ private:
 
 class StatementAST {
 public:
-    virtual ~StatementAST();
-    virtual llvm::Value *codegen() = 0;
+    enum class Kind {
+        Expr,
+        Block,
+        Return,
+        VarDecl,
+        Assign,
+        While,
+        For,
+    };
+
+    explicit StatementAST(Kind K) : K(K) {}
+    virtual llvm::Value *codegen(CompilerInstance &CI) = 0;
+    // appends the name of every function this statement calls
+    virtual void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const = 0;
+
+    inline Kind getKind() const { return K; }
+    // the token the statement starts at
+    inline position getLoc() const { return Loc; }
+    inline void setLoc(position P) { Loc = P; }
 
-    // todo: enum
-    std::string Type;
+private:
+    const Kind K;
+    position Loc;
 };
 
 class ExprStatementAST : public StatementAST {
 public:
-    explicit ExprStatementAST(std::unique_ptr<ExprAST> Expr);
-    llvm::Value *codegen() override;
+    explicit ExprStatementAST(ExprAST *Expr);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
 
 private:
-    std::unique_ptr<ExprAST> Expr;
+    friend class Sema;
+
+    ExprAST *Expr;
 };
 
 class BlockStatementAST : public StatementAST {
 public:
-    explicit BlockStatementAST(std::vector<std::unique_ptr<StatementAST>> Statements);
-    llvm::Value *codegen() override;
+    explicit BlockStatementAST(llvm::ArrayRef<StatementAST *> Statements);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
 
-    inline const std::vector<std::unique_ptr<StatementAST>> &getStatements() const { return Statements; }
+    inline llvm::ArrayRef<StatementAST *> getStatements() const { return Statements; }
 
 private:
-    std::vector<std::unique_ptr<StatementAST>> Statements;
+    llvm::ArrayRef<StatementAST *> Statements;
 };
 
 class ReturnStatementAST : public StatementAST {
 public:
-    explicit ReturnStatementAST(std::unique_ptr<ExprAST> Argument);
-    llvm::Value *codegen() override;
+    explicit ReturnStatementAST(ExprAST *Argument);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
 
 private:
-    std::unique_ptr<ExprAST> Argument;
+    friend class Sema;
+
+    ExprAST *Argument;
 };
 
+// a local variable, living in a stack slot of the function (see codegen) until
+// the end of the enclosing block; starts out as zero without an initializer
 class VarDeclStatementAST : public StatementAST {
 public:
-    // todo: enum type instead of string
-    explicit VarDeclStatementAST(std::unique_ptr<ExprAST> Var, std::string Type);
-    llvm::Value *codegen() override;
+    VarDeclStatementAST(Symbol Name, Type VarType, ExprAST *Init);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+    inline Symbol getName() const { return Name; }
+    inline const Type &getVarType() const { return VarType; }
+
+private:
+    friend class Sema;
+
+    Symbol Name;
+    Type VarType;
+    // null if there is none
+    ExprAST *Init;
+};
+
+// stores into a local variable (arguments are read-only)
+class AssignStatementAST : public StatementAST {
+public:
+    AssignStatementAST(Symbol Name, ExprAST *Value);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+    inline Symbol getName() const { return Name; }
+
+private:
+    friend class Sema;
+
+    Symbol Name;
+    ExprAST *Value;
+};
+
+// tuning requests a loop can carry (`@vectorize(8) @unroll(4) for ...`),
+// emitted as llvm.loop metadata on its latch; 0 leaves the choice to LLVM
+struct LoopHints {
+    unsigned VectorizeWidth = 0;
+    unsigned UnrollCount = 0;
+};
+
+class WhileStatementAST : public StatementAST {
+public:
+    WhileStatementAST(ExprAST *Cond, StatementAST *Body, LoopHints Hints);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
 
 private:
-    std::unique_ptr<ExprAST> Var;
-    std::string Type;
+    friend class Sema;
+
+    ExprAST *Cond;
+    StatementAST *Body;
+    LoopHints Hints;
+};
+
+// `for (Init; Cond; Step) Body`; a variable declared by Init ends with the
+// loop. any of the three may be null, a missing Cond is always true
+class ForStatementAST : public StatementAST {
+public:
+    ForStatementAST(StatementAST *Init, ExprAST *Cond, StatementAST *Step,
+                    StatementAST *Body, LoopHints Hints);
+    llvm::Value *codegen(CompilerInstance &CI) override;
+    void collectCallees(llvm::SmallVectorImpl<Symbol> &Callees) const override;
+
+private:
+    friend class Sema;
+
+    StatementAST *Init;
+    ExprAST *Cond;
+    StatementAST *Step;
+    StatementAST *Body;
+    LoopHints Hints;
 };
 
 
 
 class PrototypeAST {
 public:
-    PrototypeAST(std::string Name, std::vector<std::pair<std::string /* name */, Type /* type */>> Args, Type ReturnType, bool IsVarArg);
-    llvm::Function *codegen();
+    PrototypeAST(Symbol Name, llvm::ArrayRef<std::pair<Symbol /* name */, Type /* type */>> Args, Type ReturnType, bool IsVarArg);
+    llvm::Function *codegen(CompilerInstance &CI);
 
-    inline const std::string getName() const { return Name; }
+    inline Symbol getName() const { return Name; }
+    inline llvm::ArrayRef<std::pair<Symbol, Type>> getArgs() const { return Args; }
+    inline const Type &getReturnType() const { return ReturnType; }
+    inline bool isVarArg() const { return IsVarArg; }
+    // where the function's name is
+    inline position getLoc() const { return Loc; }
+    inline void setLoc(position P) { Loc = P; }
 
 private:
-    std::string Name;
-    std::vector<std::pair<std::string, Type>> Args;
+    Symbol Name;
+    position Loc;
+    llvm::ArrayRef<std::pair<Symbol, Type>> Args;
     bool IsVarArg;
     Type ReturnType;
 };
@@ -187,14 +389,19 @@ private:
 // function definition
 class FunctionAST {
 public:
-    FunctionAST(std::unique_ptr<PrototypeAST> Proto,
-                std::unique_ptr<StatementAST> Body);
-    llvm::Function *codegen();
+    // Clones are the targets of `@clones(...)`, see EmitTargetClones
+    FunctionAST(PrototypeAST *Proto, StatementAST *Body, llvm::ArrayRef<std::string_view> Clones = {});
+    llvm::Function *codegen(CompilerInstance &CI);
+
+    inline PrototypeAST *getProto() const { return Proto; }
+    inline StatementAST *getBody() const { return Body; }
+    inline llvm::ArrayRef<std::string_view> getClones() const { return Clones; }
 
 private:
-    std::unique_ptr<PrototypeAST> Proto;
+    PrototypeAST *Proto;
     // move to block expression ast at some point; update: should be done
-    std::unique_ptr<StatementAST> Body;
+    StatementAST *Body;
+    llvm::ArrayRef<std::string_view> Clones;
 };
 
 #endif //ABHEEK_LANG_AST_HPP
@@ -0,0 +1,124 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_TYPE_HPP
+#define ABHEEK_LANG_TYPE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Type.h>
+#include <llvm/Support/Allocator.h>
+
+class TypeTable;
+
+// a handle to a type interned in a TypeTable. every distinct type exists once
+// in its table, so a Type is a single pointer, is copied freely and compares by
+// address; what it is was worked out when it was interned
+class Type {
+public:
+    enum class Kind : std::uint8_t {
+        Invalid, // a name that isn't a type; kept for its spelling
+        Void,
+        Integer,
+        FloatingPoint,
+        Pointer,
+        Vector,
+    };
+
+    // what an expression has until semantic analysis gives it a type
+    Type() = default;
+
+    // the llvm type, resolved the first time it is asked for in the current
+    // context of the table (see TypeTable::resetLLVMTypes); null if invalid
+    llvm::Type *GetLLVMType(llvm::LLVMContext &Ctx) const;
+
+    inline bool isPointer() const { return is(Kind::Pointer); }
+    inline bool isVoid() const { return is(Kind::Void); }
+    inline bool isInteger() const { return is(Kind::Integer); }
+    inline bool isFloatingPoint() const { return is(Kind::FloatingPoint); }
+    inline bool isNumeric() const { return isInteger() || isFloatingPoint(); }
+    // a vector is spelled <element>x<lanes>, e.g. f4x8 for 8 f4 lanes; the
+    // lane count is a power of two from 2 to MaxLanes
+    static constexpr unsigned MaxLanes = 64;
+    inline bool isVector() const { return is(Kind::Vector); }
+    // whether GetLLVMType can lower it
+    inline bool isValid() const { return N && N->K != Kind::Invalid; }
+
+    // bits of an integer or floating point type, or of one lane of a vector
+    inline unsigned getBitWidth() const { return N->BitWidth; }
+    // lanes of a vector, 0 for anything else
+    inline unsigned getLanes() const { return N ? N->Lanes : 0; }
+    // the type of one lane of a vector; any other type is its own element
+    inline Type getElementType() const { return isVector() ? Type(N->Inner) : *this; }
+    // the type a pointer points to
+    inline Type getPointeeType() const { return isPointer() ? Type(N->Inner) : Type(); }
+    // the way it is written in source, e.g. "s1*"
+    inline std::string_view getSpelling() const { return N ? N->Spelling : std::string_view(); }
+
+    inline bool operator==(const Type &Other) const { return N == Other.N; }
+    inline bool operator!=(const Type &Other) const { return N != Other.N; }
+
+private:
+    friend class TypeTable;
+
+    struct Node {
+        Kind K;
+        unsigned BitWidth; // of the element, for a vector
+        unsigned Lanes;
+        const Node *Inner; // the pointee or the element; null for the rest
+        std::string_view Spelling;
+        // cached by GetLLVMType; belongs to the table's current context
+        mutable llvm::Type *LLVMType;
+    };
+
+    explicit Type(const Node *N) : N(N) {}
+    inline bool is(Kind K) const { return N && N->K == K; }
+
+    const Node *N = nullptr;
+};
+
+// the types of one compilation (it lives in the ASTContext). parsing a type
+// name looks it up here once instead of comparing spellings everywhere later
+class TypeTable {
+public:
+    TypeTable();
+    TypeTable(const TypeTable &) = delete;
+    TypeTable &operator=(const TypeTable &) = delete;
+
+    // the type spelled Name, or a pointer to it; a name that isn't a type gives
+    // an invalid type that still knows how it was spelled
+    Type get(std::string_view Name, bool IsPointer = false);
+    Type getPointer(Type Pointee);
+    Type getVector(Type Element, unsigned Lanes);
+
+    inline Type getVoid() const { return Void; }
+    // Bits is 8, 16, 32 or 64
+    inline Type getInteger(unsigned Bits) const { return Integers[Log2Bytes(Bits)]; }
+    // Bits is 32 or 64
+    inline Type getFloatingPoint(unsigned Bits) const { return Bits == 32 ? F4 : F8; }
+
+    // forgets every llvm type resolved so far. call it whenever the context
+    // they were created in is replaced, before the next GetLLVMType
+    void resetLLVMTypes();
+
+    inline std::size_t size() const { return Nodes.size(); }
+
+private:
+    static constexpr unsigned Log2Bytes(unsigned Bits) {
+        return Bits == 8 ? 0 : Bits == 16 ? 1 : Bits == 32 ? 2 : 3;
+    }
+    // interns the type spelled Spelling, working out what it is the first time
+    Type intern(std::string_view Spelling);
+    Type::Node describe(std::string_view Spelling);
+
+    llvm::StringMap<Type::Node, llvm::BumpPtrAllocator> Nodes;
+    Type Void, Integers[4], F4, F8;
+};
+
+
+#endif //ABHEEK_LANG_TYPE_HPP
@@ -0,0 +1,97 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_COMPILESTATS_HPP
+#define ABHEEK_LANG_COMPILESTATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+
+// where the time of one compilation went (--time-report), plus a few counters
+// that put the times in proportion. phases are timed exclusively: time spent in
+// a nested phase (e.g. verifying inside codegen) is only charged to that phase
+class CompileStats {
+public:
+    enum Phase : unsigned {
+        // time outside every phase
+        None,
+        Read,
+        Lex,
+        Parse,
+        Sema,
+        Codegen,
+        Verify,
+        Optimize,
+        Emit,
+        NumPhases,
+    };
+
+    static llvm::StringRef getPhaseName(Phase P);
+
+    // starts charging time to P; returns the phase that was being charged until now
+    Phase enterPhase(Phase P);
+
+    void print(llvm::raw_ostream &OS) const;
+
+    double Seconds[NumPhases] = {};
+
+    std::uint64_t SourceBytes = 0;
+    std::uint64_t Tokens = 0;
+    std::uint64_t ASTNodes = 0;
+    std::uint64_t BytesEmitted = 0;
+    // definitions left out because nothing reaches them (--only-reachable)
+    std::uint64_t SkippedFunctions = 0;
+
+    struct FunctionStats {
+        std::string Name;
+        // generating it, verifying included
+        double Seconds;
+        unsigned IRInstructions;
+    };
+    // every function definition, in source order
+    std::vector<FunctionStats> Functions;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Phase Current = None;
+    Clock::time_point Since = Clock::now();
+};
+
+// charges the time until it goes out of scope to a phase of Stats (which may be
+// null when nobody asked for a report) and records it as a span for --trace
+class PhaseTimer {
+public:
+    PhaseTimer(CompileStats *Stats, CompileStats::Phase P, llvm::StringRef Detail = "")
+            : Stats(Stats), Trace(CompileStats::getPhaseName(P), Detail) {
+        if (Stats) {
+            Start = std::chrono::steady_clock::now();
+            Outer = Stats->enterPhase(P);
+        }
+    }
+    ~PhaseTimer() {
+        if (Stats)
+            Stats->enterPhase(Outer);
+    }
+
+    // wall time since the timer started, nested phases included
+    double getSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    }
+
+private:
+    CompileStats *Stats;
+    CompileStats::Phase Outer = CompileStats::None;
+    std::chrono::steady_clock::time_point Start;
+    llvm::TimeTraceScope Trace;
+};
+
+
+#endif //ABHEEK_LANG_COMPILESTATS_HPP
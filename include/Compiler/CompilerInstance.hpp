@@ -0,0 +1,190 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_COMPILERINSTANCE_HPP
+#define ABHEEK_LANG_COMPILERINSTANCE_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/GlobalIFunc.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "Compiler/CompileStats.hpp"
+#include "Compiler/FunctionCache.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Parser/Parser.hpp"
+#include "Sema/Sema.hpp"
+#include "Symbol/Symbol.hpp"
+
+// settings for one compilation, chosen by the driver
+struct CompilerOptions {
+    // -O0 skips the optimization pipeline entirely, unless it has to instrument
+    llvm::OptimizationLevel OptLevel = llvm::OptimizationLevel::O0;
+    // triple to generate code for; empty means the host
+    std::string TargetTriple;
+    // CPU to generate code for (empty means "generic") and target features on
+    // top of the ones it has, as +feature/-feature separated by commas
+    std::string CPU;
+    std::string Features;
+    // where optimized function definitions are kept between builds; empty means no
+    // cache, and -O0 doesn't use one. with a cache every definition is compiled and
+    // optimized on its own, so there is no inlining across functions
+    std::string CacheDir;
+    // parse the whole unit before generating any code, then only generate the
+    // definitions reachable from main, Exports and the top-level statements. the
+    // rest are left out of the module (and the object file) altogether
+    bool OnlyReachable = false;
+    // functions other units call into; only read when OnlyReachable is set
+    std::vector<std::string> Exports;
+    // the output is ThinLTO bitcode (SaveBitcodeToFile) instead of an object: the
+    // optimizer only runs the pre-link pipeline and leaves the rest to the link step
+    bool EmitBitcode = false;
+    // instrument every function with profile counters and link in the runtime
+    // that writes them (see ProfileRuntime.hpp) to this .profraw path at exit;
+    // empty means no instrumentation
+    std::string ProfileGenerate;
+    // an indexed .profdata (merged from .profraw files with llvm-profdata) whose
+    // counts become branch weights and function entry counts before the
+    // optimizer runs; it has to come from a build at the same -O level
+    std::string ProfileUse;
+    // the module is run by a JITSession (--run, --repl) rather than written out.
+    // the JIT already generates code for the host's CPU, and can't call through
+    // an ifunc, so functions with clones only get their default body
+    bool JIT = false;
+    // -g: line tables, i.e. a DISubprogram for every function and a source
+    // position on every instruction, so profilers and debuggers can map code
+    // back to the .ad file. the optimizer keeps them up to date as it goes and
+    // generates the same code either way
+    bool DebugInfo = false;
+    // run llvm::verifyFunction on every function as it is generated;
+    // only worth its cost while working on the compiler itself
+#ifdef DEBUG
+    bool VerifyFunctions = true;
+#else
+    bool VerifyFunctions = false;
+#endif
+};
+
+// everything needed to compile one translation unit: lexer and parser state
+// plus the LLVM context, builder and module that codegen writes into.
+// instances share nothing, so separate units can be compiled on separate threads.
+class CompilerInstance {
+public:
+    // Source is not copied and has to outlive the instance (see Lexer)
+    CompilerInstance(std::string_view Source, std::string ModuleName, CompilerOptions Options = {});
+
+    // opens a fresh context and module; can be called again once the previous
+    // module has been taken (see TakeModule) to compile the next piece of input
+    int InitializeModule();
+    // parses, checks and generates code for the whole token buffer
+    void MainLoop();
+    // runs the new pass manager's default pipeline for Options.OptLevel. with a
+    // cache, the definitions compiled (or reused) on their own are linked in after,
+    // and so is the profile runtime when the module is instrumented
+    void OptimizeModule();
+
+    // with debug info, gives F (a definition or top-level statement wrapper
+    // starting at Loc) its DISubprogram and points the builder at Loc in it
+    void EmitSubprogram(llvm::Function *F, position Loc);
+    // closes F's DISubprogram once its body is complete, so it can be verified
+    void FinishSubprogram(llvm::Function *F);
+    // with debug info, the position of the instructions generated from here
+    // on, in the function being generated
+    void EmitLocation(position Loc);
+
+    // the function called Name in the current module, declaring it from its
+    // prototype if it was declared or defined while compiling an earlier module
+    llvm::Function *GetFunction(Symbol Name);
+
+    void SaveModuleToFile(const std::string &path);
+    int SaveObjectToFile(const std::string &path);
+    // bitcode with the module summary a ThinLTO link (see ThinLTOLink) needs
+    int SaveBitcodeToFile(const std::string &path);
+    // hands the module and the context it lives in over (e.g. to a JITSession);
+    // nothing can be generated into this instance afterwards
+    llvm::orc::ThreadSafeModule TakeModule();
+
+    // identifiers of this unit; the lexer interns into it and codegen reads names back out
+    StringInterner Names;
+    Lexer Lex;
+    // every AST node parsed for this unit; freed in one go with the instance
+    ASTContext AST;
+    Parser Parse;
+
+    std::string ModuleName;
+    CompilerOptions Options;
+    // where the phases below charge their time; null unless the driver wants a report
+    CompileStats *Stats = nullptr;
+
+    std::unique_ptr<llvm::LLVMContext> TheContext;
+    std::unique_ptr<llvm::IRBuilder<>> Builder;
+    std::unique_ptr<llvm::Module> TheModule;
+    // null unless Options.DebugInfo is set; the compile unit of the current module
+    std::unique_ptr<llvm::DIBuilder> DBuilder;
+    llvm::DICompileUnit *DebugUnit = nullptr;
+    // owned by the per-thread target cache (see Target.hpp) and reused by every instance
+    llvm::TargetMachine *TheTargetMachine = nullptr;
+    // symbol-indexed, so codegen never hashes or compares a name. arguments
+    // are bound to their value; local variables to the stack slot (an
+    // AllocaInst) they live in until the optimizer promotes them to registers
+    SymbolTable<llvm::Value *> NamedValues;
+    SymbolTable<llvm::Function *> Functions;
+    // the ifuncs of the functions in Functions that have clones; calls go to these
+    SymbolTable<llvm::GlobalIFunc *> IFuncs;
+    // every extern and definition seen so far; unlike Functions it survives InitializeModule
+    SymbolTable<PrototypeAST *> Prototypes;
+    // types every definition and top-level statement before it is generated
+    Sema Analysis;
+    // names of the functions wrapping the top-level statements of the current module, in order
+    std::vector<std::string> TopLevelExprs;
+
+    // null unless Options.CacheDir is set and the module is optimized
+    std::unique_ptr<FunctionCache> Cache;
+    // definitions of the current module that were compiled apart from it, waiting to be linked in
+    std::vector<std::unique_ptr<llvm::Module>> DefinitionModules;
+    // the functions those modules define, to catch a redefinition before the linker does
+    llvm::DenseSet<Symbol> SeparatelyDefined;
+
+private:
+    void HandleDefinition();
+    void HandleExtern();
+    void HandleTopLevelExpression();
+    // Tokens are the definition's own, for its cache key
+    void CodegenDefinition(FunctionAST *Definition, llvm::ArrayRef<Token> Tokens);
+    // wraps a top-level statement in an anonymous function returning its value (if any)
+    llvm::Function *CodegenTopLevelStatement(StatementAST *Statement);
+    // generates the deferred definitions that can be reached and the deferred statements, in source order
+    void CodegenReachable();
+    // a definition in a module of its own, taken from the cache or compiled and stored there
+    std::unique_ptr<llvm::Module> CodegenCachedDefinition(FunctionAST *Definition, llvm::ArrayRef<Token> Tokens);
+    // cache key of a definition: its tokens, the signatures of the functions they
+    // name and every option that changes the generated code
+    std::string GetDefinitionKey(llvm::ArrayRef<Token> Tokens);
+    void RunOptimizationPipeline(llvm::Module &M);
+
+    // what MainLoop parsed but held back from codegen (see Options.OnlyReachable)
+    struct DeferredItem {
+        // exactly one of the two is set
+        FunctionAST *Definition;
+        StatementAST *Statement;
+        llvm::ArrayRef<Token> Tokens;
+    };
+    std::vector<DeferredItem> Deferred;
+
+    // keeps wrapper names unique across every module of the instance
+    unsigned AnonExprCount = 0;
+};
+
+
+#endif //ABHEEK_LANG_COMPILERINSTANCE_HPP
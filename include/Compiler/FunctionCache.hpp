@@ -0,0 +1,37 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_FUNCTIONCACHE_HPP
+#define ABHEEK_LANG_FUNCTIONCACHE_HPP
+
+#include <memory>
+#include <string>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+// content-addressed on-disk store of compiled function definitions. every
+// entry is the optimized bitcode of a module holding a single definition,
+// filed under a key that covers everything its code depends on (see
+// CompilerInstance::GetDefinitionKey), so an entry never has to be invalidated.
+// several compiles (or -j workers) can share a directory.
+class FunctionCache {
+public:
+    // creates Dir if needed; throws std::runtime_error if that fails
+    explicit FunctionCache(std::string Dir);
+
+    // the module stored under Key, read into Ctx; null if there is none (or it's unreadable)
+    std::unique_ptr<llvm::Module> load(llvm::StringRef Key, llvm::LLVMContext &Ctx);
+    // files M under Key; a failure only costs a later cache miss, so it is just reported
+    void store(llvm::StringRef Key, const llvm::Module &M);
+
+private:
+    std::string getPath(llvm::StringRef Key) const;
+
+    std::string Dir;
+};
+
+
+#endif //ABHEEK_LANG_FUNCTIONCACHE_HPP
@@ -0,0 +1,38 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_JITSESSION_HPP
+#define ABHEEK_LANG_JITSESSION_HPP
+
+#include <memory>
+#include <string>
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+
+// an ORC LLJIT that runs generated code inside the compiler's own process.
+// externs that no added module defines (printf, ...) are resolved against
+// whatever the host process exports, so nothing has to be linked.
+class JITSession {
+public:
+    // throws std::runtime_error if the host target can't be set up
+    JITSession();
+
+    const llvm::DataLayout &getDataLayout() const;
+
+    // takes ownership of a finished module and the context it lives in
+    void addModule(llvm::orc::ThreadSafeModule TSM);
+    // address of a symbol defined by one of the added modules (or the host)
+    llvm::JITTargetAddress lookup(llvm::StringRef Name);
+
+    // calls `main` with argv = {ProgramName, Args...} and returns its exit code
+    int runMain(llvm::StringRef ProgramName, llvm::ArrayRef<std::string> Args);
+
+private:
+    std::unique_ptr<llvm::orc::LLJIT> JIT;
+};
+
+
+#endif //ABHEEK_LANG_JITSESSION_HPP
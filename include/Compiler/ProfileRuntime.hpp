@@ -0,0 +1,27 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_PROFILERUNTIME_HPP
+#define ABHEEK_LANG_PROFILERUNTIME_HPP
+
+#include <memory>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+// the part of compiler-rt's profile runtime an instrumented program needs,
+// linked into every module built with --profile-generate so nothing has to be
+// added to the link. at exit it writes the counters to $LLVM_PROFILE_FILE, or
+// DefaultPath if that isn't set, as a raw profile that `llvm-profdata merge`
+// turns into the indexed .profdata --profile-use reads. everything is weak, so
+// several instrumented objects in one program share a single copy.
+// counters only: value profiles aren't collected (see --profile-generate), and
+// the sections are found the way ELF linkers expose them, so the target has to
+// be 64-bit ELF. throws std::runtime_error for any other target
+std::unique_ptr<llvm::Module> CreateProfileRuntime(llvm::LLVMContext &Ctx, const llvm::Module &Instrumented,
+                                                   llvm::StringRef DefaultPath);
+
+
+#endif //ABHEEK_LANG_PROFILERUNTIME_HPP
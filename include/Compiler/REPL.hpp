@@ -0,0 +1,39 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_REPL_HPP
+#define ABHEEK_LANG_REPL_HPP
+
+#include <deque>
+#include <iosfwd>
+#include <string>
+
+#include "Compiler/CompilerInstance.hpp"
+#include "Compiler/JITSession.hpp"
+
+// interactive session: reads one extern, definition or statement at a time,
+// compiles it into a module of its own and adds that to a JIT that lives as
+// long as the session. definitions stay resident, so an entry only costs the
+// time to compile itself; top-level statements run right away and their value
+// is printed.
+class REPL {
+public:
+    explicit REPL(CompilerOptions Options);
+
+    // reads entries from In until it runs out; returns the process exit code
+    int run(std::istream &In, std::ostream &Out);
+
+private:
+    void evaluate(std::string Input, std::ostream &Out);
+
+    // every entry so far, since tokens and AST nodes view into them
+    std::deque<std::string> Inputs;
+    // one instance for the whole session: names, prototypes and AST persist,
+    // only the module is replaced for each entry
+    CompilerInstance CI;
+    JITSession JIT;
+};
+
+
+#endif //ABHEEK_LANG_REPL_HPP
@@ -0,0 +1,43 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_TARGET_HPP
+#define ABHEEK_LANG_TARGET_HPP
+
+#include <memory>
+#include <string>
+
+#include <llvm/IR/DataLayout.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+
+// a TargetMachine together with the data layout every module compiled for it gets
+struct CachedTarget {
+    std::unique_ptr<llvm::TargetMachine> Machine;
+    llvm::DataLayout Layout;
+};
+
+// backend effort matching the middle-end optimization level
+llvm::CodeGenOpt::Level GetCodeGenOptLevel(const llvm::OptimizationLevel &Level);
+
+// registers the host target with LLVM; only the first call does any work
+void InitializeHostTarget();
+
+// what -march=native turns on: every feature the CPU the compiler runs on has,
+// as a comma-separated list of +feature/-feature in a stable order
+std::string GetHostCPUFeatures();
+
+// the target for Triple (the host's if empty) at the given backend level,
+// generating code for CPU ("generic" if empty) with Features (+feature/-feature,
+// comma-separated) on top of what the CPU has. created the first time it is
+// asked for and reused after that. only the host target is registered unless
+// another one is asked for (which needs a build with ABHEEK_LANG_ALL_TARGETS).
+// a TargetMachine can't be shared between threads, so every thread gets its own.
+// returns null and sets Error if the target isn't available or doesn't know the CPU
+CachedTarget *GetCachedTarget(const std::string &Triple, const std::string &CPU, const std::string &Features,
+                              llvm::CodeGenOpt::Level Level, std::string &Error);
+
+
+#endif //ABHEEK_LANG_TARGET_HPP
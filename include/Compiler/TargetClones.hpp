@@ -0,0 +1,32 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_TARGETCLONES_HPP
+#define ABHEEK_LANG_TARGETCLONES_HPP
+
+#include <string_view>
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalIFunc.h>
+#include <llvm/Target/TargetMachine.h>
+
+// what `@clones(...)` in front of a definition does to its finished function F:
+// F becomes the default body (internal, renamed <name>.default), a copy of it
+// is generated for each of Targets, and an ifunc that takes F's name picks one
+// of them when the program is loaded. a target is either an x86 feature the
+// CPU can be tested for at run time ("avx2", "avx512f", ...) or "arch=<cpu>"
+// for every such feature that CPU has; "default" is accepted like GCC's
+// target_clones but always implied. the resolver takes the clone with the
+// highest priority feature that the CPU supports, or the default body.
+// every use of F so far (recursive calls, callers that saw an extern) is moved
+// over to the ifunc. TM supplies the CPU and features the default body and the
+// feature clones start from.
+// throws std::runtime_error for an unknown target, or a target machine other
+// than x86-64 ELF (ifuncs need the dynamic loader's IRELATIVE relocations)
+llvm::GlobalIFunc *EmitTargetClones(llvm::Function &F, llvm::ArrayRef<std::string_view> Targets,
+                                    const llvm::TargetMachine &TM);
+
+
+#endif //ABHEEK_LANG_TARGETCLONES_HPP
@@ -0,0 +1,26 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_THINLTOLINK_HPP
+#define ABHEEK_LANG_THINLTOLINK_HPP
+
+#include <string>
+
+#include <llvm/ADT/ArrayRef.h>
+
+#include "Compiler/CompilerInstance.hpp"
+
+// the ThinLTO link step over bitcode written with --emit=bc. the summaries of
+// all Inputs go into one combined index, which decides what each module
+// imports from the others (small callees, and hot ones more eagerly); then
+// every module is optimized and generated on its own, Jobs at a time
+// (0 = all cores), into the object file Outputs[i] for Inputs[i].
+// only main and Options.Exports stay visible to objects outside the link, so
+// everything else can be internalized and dropped once it is inlined.
+// throws std::runtime_error if an input can't be read or the link fails
+void ThinLTOLink(llvm::ArrayRef<std::string> Inputs, llvm::ArrayRef<std::string> Outputs,
+                 const CompilerOptions &Options, unsigned Jobs);
+
+
+#endif //ABHEEK_LANG_THINLTOLINK_HPP
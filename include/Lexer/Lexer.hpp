@@ -5,27 +5,42 @@
 #ifndef ABHEEK_LANG_LEXER_HPP
 #define ABHEEK_LANG_LEXER_HPP
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Symbol/Symbol.hpp"
 #include "Token/Token.hpp"
 
 class Lexer {
 public:
-    Lexer();
-    Lexer(std::string source);
+    // the source is not copied; it must outlive every token and be
+    // null-terminated one past its end (llvm::MemoryBuffer guarantees both).
+    // identifiers are interned into Names as they are lexed
+    Lexer(std::string_view source, StringInterner &Names);
 
     ~Lexer();
 
-    static std::string Source;
+    std::string_view Source;
+    StringInterner &Names;
 
-    static Token getTok();
-    static char LastChar;
-    static int CharIdx;
+    Token getTok();
+    // lexes all of Source into Tokens in a single pass; the last token is always tok_eof
+    void Tokenize();
+    // starts over on a new source (e.g. the next line of a REPL session). strings
+    // decoded so far are kept, since tokens and AST nodes may still view into them
+    void reset(std::string_view source);
+    char LastChar = ' ';
+    int CharIdx = 0;
 
-    static position Position;
+    position Position;
 
-    static std::vector<Token> Tokens;
+    std::vector<Token> Tokens;
+
+    // backing storage for string literals that contained escape sequences;
+    // every other token value is a view straight into Source
+    std::deque<std::string> DecodedStrings;
 };
 
 
@@ -5,6 +5,7 @@
 #ifndef ABHEEK_LANG_PARSER_HPP
 #define ABHEEK_LANG_PARSER_HPP
 
+#include <algorithm>
 #include <map>
 
 #include "AST/AST.hpp"
@@ -13,37 +14,65 @@
 
 class Parser {
 public:
-    // ctor
-    // Parser();
+    // the parser only reads Tokens (the lexer that owns them must outlive it)
+    // and allocates every node it builds from AST
+    Parser(const std::vector<Token> &Tokens, ASTContext &AST);
 
-    static inline Token getNextToken() { return CurrentToken = Lexer::getTok(); }
-    static Token CurrentToken;
+    // k-token lookahead over the token buffer; peek() is the current token and
+    // looking past the end keeps returning the trailing tok_eof
+    inline const Token &peek(std::size_t k = 0) const {
+        return Tokens[std::min(TokenIdx + k, Tokens.size() - 1)];
+    }
+    inline const Token &advance() {
+        if (TokenIdx + 1 < Tokens.size())
+            TokenIdx++;
+        return peek();
+    }
+    // back to the first token, after the lexer has been refilled
+    inline void reset() { TokenIdx = 0; }
+    const std::vector<Token> &Tokens;
+    std::size_t TokenIdx = 0;
+    ASTContext &AST;
 
     // EXPRESSION BEGIN
-    static std::unique_ptr<ExprAST> ParseExpression();
+    ExprAST *ParseExpression();
 
-    static std::unique_ptr<ExprAST> ParseNumberExpr();
-    static std::unique_ptr<ExprAST> ParseStringExpr();
-    static std::unique_ptr<ExprAST> ParseParenExpr();
-    static std::unique_ptr<ExprAST> ParseIdentifierExpr();
+    ExprAST *ParseNumberExpr();
+    ExprAST *ParseStringExpr();
+    ExprAST *ParseParenExpr();
+    ExprAST *ParseIdentifierExpr();
 
-    static std::unique_ptr<ExprAST> ParsePrimary();
+    ExprAST *ParsePrimary();
 
-    static std::unique_ptr<PrototypeAST> ParsePrototype();
-    static std::unique_ptr<FunctionAST> ParseFuncDefinition();
-    static std::unique_ptr<PrototypeAST> ParseExtern();
+    PrototypeAST *ParsePrototype();
+    // `func`, with an `@clones(...)` in front of it if the function has clones
+    FunctionAST *ParseFuncDefinition();
+    PrototypeAST *ParseExtern();
 
-    static std::unique_ptr<ExprAST> ParseBinOpRight(int Precedence, std::unique_ptr<ExprAST> Left);
+    ExprAST *ParseBinOpRight(int Precedence, ExprAST *Left);
     // EXPRESSION END
 
     // STATEMENT BEGIN
-    static std::unique_ptr<StatementAST> ParseStatement();
+    StatementAST *ParseStatement();
 
-    static std::unique_ptr<StatementAST> ParseExprStatement();
-    static std::unique_ptr<StatementAST> ParseBlockStatement();
-    static std::unique_ptr<StatementAST> ParseReturnStatement();
-    static std::unique_ptr<StatementAST> ParseVarDeclStatement();
+    StatementAST *ParseExprStatement();
+    StatementAST *ParseBlockStatement();
+    StatementAST *ParseReturnStatement();
+    StatementAST *ParseVarDeclStatement();
+    // the for loop's step is an assignment without the ';'
+    StatementAST *ParseAssignStatement(bool ExpectSemicolon = true);
+    // `for`/`while` with any `@hint(n)`s in front of them
+    StatementAST *ParseLoopStatement();
+    LoopHints ParseLoopHints();
     //STATEMENT END
+
+private:
+    // records where Node starts in the source, for debug info
+    template<typename T>
+    static T *at(position Loc, T *Node) {
+        Node->setLoc(Loc);
+        return Node;
+    }
 };
 
 
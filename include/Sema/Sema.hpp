@@ -0,0 +1,74 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_SEMA_HPP
+#define ABHEEK_LANG_SEMA_HPP
+
+#include <llvm/ADT/Twine.h>
+
+#include "AST/AST.hpp"
+#include "Symbol/Symbol.hpp"
+
+// type checking between parsing and codegen. gives every expression of a
+// definition or top-level statement its exact type from the declarations it
+// uses, sizes number literals to the type they are used at and turns every
+// implicit conversion into a CastExprAST, so codegen never has to guess.
+// errors are thrown as std::runtime_error like the parser's.
+class Sema {
+public:
+    // Prototypes is what calls are checked against (see CompilerInstance);
+    // casts are allocated from AST
+    Sema(ASTContext &AST, StringInterner &Names, SymbolTable<PrototypeAST *> &Prototypes);
+
+    // checks the types a prototype names and that it agrees with any earlier
+    // declaration of the same function; call before registering it
+    void checkPrototype(const PrototypeAST *Proto);
+    // the body of a definition whose prototype has been registered already
+    void checkDefinition(FunctionAST *Definition);
+    void checkTopLevelStatement(StatementAST *Statement);
+
+private:
+    // every check starts outside any loop or block
+    void resetDepths();
+    void checkStatement(StatementAST *S);
+    // a loop condition is true when it isn't 0, so it has to be an integer
+    void checkCondition(ExprAST *&Cond);
+
+    // the type of E on its own; a literal gets its default type
+    Type infer(ExprAST *&E);
+    Type inferBinary(BinaryExprAST *B);
+    Type inferCall(CallExprAST *C);
+    // the node that replaces a call to a builtin, with its arguments checked
+    ExprAST *checkBuiltin(CallExprAST *C, BuiltinExprAST::Builtin Op);
+    // converts E to To where the language does so implicitly: literals take
+    // the type as is, other numbers get a cast. Where is only built for an error
+    void convert(ExprAST *&E, const Type &To, const llvm::Twine &Where);
+
+    // a number literal, or arithmetic on nothing but number literals: it has
+    // no type of its own until it is used somewhere
+    static bool isUntyped(const ExprAST *E);
+    // the type of an untyped expression used where nothing asks for one: s4,
+    // or s8 for a value that needs it, or f8 if any of it is floating point
+    Type getDefaultType(const ExprAST *E) const;
+    // gives an untyped expression (and every literal in it) the type T
+    void setLiteralType(ExprAST *E, const Type &T) const;
+
+    ASTContext &AST;
+    StringInterner &Names;
+    SymbolTable<PrototypeAST *> &Prototypes;
+    // the types the language itself uses, from AST's type table
+    const Type S1, S4, S8, F4, F8, String, Void;
+
+    // the definition being checked; null at the top level
+    const PrototypeAST *CurrentFunction = nullptr;
+    // the arguments and local variables in scope
+    SymbolTable<const Type *> Variables;
+    // how many loops the statement being checked is in
+    unsigned LoopDepth = 0;
+    // how many blocks; a return only ends the block it is directly in
+    unsigned BlockDepth = 0;
+};
+
+
+#endif //ABHEEK_LANG_SEMA_HPP
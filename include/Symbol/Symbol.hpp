@@ -0,0 +1,85 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#ifndef ABHEEK_LANG_SYMBOL_HPP
+#define ABHEEK_LANG_SYMBOL_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Allocator.h>
+
+// an interned identifier: a dense index into the StringInterner that produced it
+using Symbol = std::uint32_t;
+inline constexpr Symbol NoSymbol = ~Symbol(0);
+
+// per-compilation identifier table. every distinct name is hashed once, when it
+// is lexed; after that it is only ever handled as a Symbol
+class StringInterner {
+public:
+    Symbol intern(std::string_view Name);
+
+    // the interner owns the characters, so the name outlives the source it came from
+    inline llvm::StringRef getName(Symbol S) const { return Names[S]; }
+    inline std::size_t size() const { return Names.size(); }
+
+private:
+    llvm::StringMap<Symbol, llvm::BumpPtrAllocator> Map;
+    std::vector<llvm::StringRef> Names;
+};
+
+// maps symbols to values with nested scopes. lookups index a flat vector by
+// symbol, and each scope keeps an undo log of the entries it shadowed so that
+// popping it restores the enclosing bindings
+template<typename T>
+class SymbolTable {
+public:
+    inline T lookup(Symbol S) const { return S < Values.size() ? Values[S] : T(); }
+
+    void insert(Symbol S, T Value) {
+        if (S >= Values.size())
+            Values.resize(S + 1);
+        Shadowed.emplace_back(S, Values[S]);
+        Values[S] = Value;
+    }
+
+    // drops every binding, e.g. when the values they point to go away
+    void clear() {
+        Values.clear();
+        Shadowed.clear();
+        ScopeStarts.clear();
+    }
+
+    inline void pushScope() { ScopeStarts.push_back(Shadowed.size()); }
+
+    void popScope() {
+        std::size_t Start = ScopeStarts.back();
+        ScopeStarts.pop_back();
+        while (Shadowed.size() > Start) {
+            Values[Shadowed.back().first] = Shadowed.back().second;
+            Shadowed.pop_back();
+        }
+    }
+
+    // ends the innermost scope but keeps its bindings, as if they had been
+    // made in the enclosing one
+    void keepScope() {
+        ScopeStarts.pop_back();
+        // nothing is left to pop back to
+        if (ScopeStarts.empty())
+            Shadowed.clear();
+    }
+
+private:
+    std::vector<T> Values;
+    std::vector<std::pair<Symbol, T>> Shadowed;
+    std::vector<std::size_t> ScopeStarts;
+};
+
+
+#endif //ABHEEK_LANG_SYMBOL_HPP
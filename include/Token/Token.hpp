@@ -5,8 +5,19 @@
 #ifndef ABHEEK_LANG_TOKEN_HPP
 #define ABHEEK_LANG_TOKEN_HPP
 
-#include <map>
 #include <string>
+#include <string_view>
+
+#include "Symbol/Symbol.hpp"
+
+// binary operators, resolved from their spelling once at parse time
+enum class BinaryOp : unsigned char {
+    Mul, Div, Rem,
+    Add, Sub,
+    Shl, Shr,
+    Lt, Le, Gt, Ge,
+    None
+};
 
 struct position {
     int row = 1; // line
@@ -23,6 +34,8 @@ public:
         tok_extern = -3,
         tok_return = -4,
         tok_var = -5,
+        tok_while = -6,
+        tok_for = -7,
 
         // primary
         tok_ident = -20,
@@ -38,16 +51,82 @@ public:
 
     Token();
     explicit Token(type type);
-    Token(type type, std::string value, position position);
+    Token(type type, std::string_view value, position position);
+
+    // resolves operator text to its opcode; BinaryOp::None if Op is not an operator
+    static constexpr BinaryOp GetBinaryOp(std::string_view Op) {
+        switch (Op.size()) {
+            case 1:
+                switch (Op[0]) {
+                    case '*': return BinaryOp::Mul;
+                    case '/': return BinaryOp::Div;
+                    case '%': return BinaryOp::Rem;
+                    case '+': return BinaryOp::Add;
+                    case '-': return BinaryOp::Sub;
+                    case '<': return BinaryOp::Lt;
+                    case '>': return BinaryOp::Gt;
+                    default: return BinaryOp::None;
+                }
+            case 2:
+                if (Op[0] != '<' && Op[0] != '>')
+                    return BinaryOp::None;
+                if (Op[1] == Op[0]) // << >>
+                    return Op[0] == '<' ? BinaryOp::Shl : BinaryOp::Shr;
+                if (Op[1] == '=') // <= >=
+                    return Op[0] == '<' ? BinaryOp::Le : BinaryOp::Ge;
+                return BinaryOp::None;
+            default:
+                return BinaryOp::None;
+        }
+    }
+
+    // binary operator precedence (lower binds tighter); 0 if Op is not an operator
+    static constexpr int GetBinOpPrecedence(BinaryOp Op) {
+        constexpr int Precedences[] = {
+                5, 5, 5, // * / %
+                6, 6,    // + -
+                7, 7,    // << >>
+                9, 9, 9, 9, // < <= > >=
+                0,       // None
+        };
+        return Precedences[(int)Op];
+    }
+    static constexpr int GetBinOpPrecedence(std::string_view Op) { return GetBinOpPrecedence(GetBinaryOp(Op)); }
+
+    // characters that can start or continue an operator token
+    static constexpr bool IsOpChar(char C) { return GetBinOpPrecedence(std::string_view(&C, 1)); }
 
-    static std::map<std::string, int> BinOpPrecedence;
-    static void InitBinOps();
+    // keyword token type for an identifier, or tok_ident if it isn't one
+    static constexpr enum type GetKeywordType(std::string_view Ident) {
+        switch (Ident.size()) {
+            case 3:
+                if (Ident == "var") return tok_var;
+                if (Ident == "for") return tok_for;
+                break;
+            case 4:
+                if (Ident == "func") return tok_func;
+                break;
+            case 5:
+                if (Ident == "while") return tok_while;
+                break;
+            case 6:
+                if (Ident == "extern") return tok_extern;
+                if (Ident == "return") return tok_return;
+                break;
+            default:
+                break;
+        }
+        return tok_ident;
+    }
 
-    int GetPrecedence();
-    inline bool IsBinOp() const { return BinOpPrecedence[value]; }
+    int GetPrecedence() const;
+    inline bool IsBinOp() const { return GetBinOpPrecedence(value); }
 
     type type;
-    std::string value;
+    // interned name of identifiers; NoSymbol for every other token
+    Symbol sym = NoSymbol;
+    // view into the lexer's source buffer (or its decoded string storage)
+    std::string_view value;
     position pos;
 };
 
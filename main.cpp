@@ -1,153 +1,451 @@
-#include <fstream>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
-#include <sstream>
+#include <mutex>
 
-#include "Lexer/Lexer.hpp"
-#include "Parser/Parser.hpp"
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Host.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/TimeProfiler.h>
+
+#include "Compiler/CompileStats.hpp"
+#include "Compiler/CompilerInstance.hpp"
+#include "Compiler/JITSession.hpp"
+#include "Compiler/REPL.hpp"
+#include "Compiler/Target.hpp"
+#include "Compiler/ThinLTOLink.hpp"
 #include "Token/Token.hpp"
 
 const char *out_file = "out.ll";
 
-// todo: add much better logging for parsed stuff
-static void HandleDefinition() {
-    if (auto FnAST = Parser::ParseFuncDefinition()) {
-        if (auto *FnIR = FnAST->codegen()) {
-            // fprintf(stderr, "Read function definition:\n");
-            // FnIR->print(llvm::errs());
-            // fprintf(stderr, "\n");
-        }
-        //printf("Parsed a function definition.\n");
-    } else {
-        // Skip token for error recovery.
-        Parser::getNextToken();
-    }
-}
+static llvm::cl::OptionCategory CompilerCategory("abheek_lang options");
 
-static void HandleExtern() {
-    if (auto ProtoAST = Parser::ParseExtern()) {
-        if (auto *ProtoIR = ProtoAST->codegen()) {
-            // fprintf(stderr, "Read proto definition:\n");
-            // ProtoIR->print(llvm::errs());
-            // fprintf(stderr, "\n");
-        }
+static llvm::cl::list<std::string> InputFilenames(llvm::cl::Positional, llvm::cl::ZeroOrMore,
+                                                  llvm::cl::desc("<path to file>..."), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> OutputFilename("o", llvm::cl::desc("file to write (single input only)"),
+                                                 llvm::cl::value_desc("path"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<unsigned> Jobs("j", llvm::cl::desc("number of inputs to compile in parallel (0 = all cores)"),
+                                    llvm::cl::value_desc("N"), llvm::cl::Prefix, llvm::cl::init(1),
+                                    llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<char> OptLevel("O", llvm::cl::desc("optimization level: -O0, -O1, -O2, -O3, -Os or -Oz (default -O0)"),
+                                     llvm::cl::Prefix, llvm::cl::init('0'), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> TargetTriple("target", llvm::cl::desc("triple to generate code for (default: the host)"),
+                                               llvm::cl::value_desc("triple"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> March("march", llvm::cl::desc("'native' generates code for the CPU the compiler runs "
+                                                                "on, using every feature it has"),
+                                        llvm::cl::value_desc("native"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> MCPU("mcpu", llvm::cl::desc("CPU to generate code for (default: generic)"),
+                                       llvm::cl::value_desc("cpu"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::list<std::string> MAttrs("mattr", llvm::cl::desc("target features to turn on (+feature) or off "
+                                                                  "(-feature) on top of the CPU's"),
+                                          llvm::cl::value_desc("+a,-b,..."), llvm::cl::CommaSeparated,
+                                          llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> CacheDir("cache-dir",
+                                           llvm::cl::desc("reuse optimized function definitions kept in this "
+                                                          "directory, and add new ones to it (not used at -O0)"),
+                                           llvm::cl::value_desc("path"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> VerifyFunctions("verify-functions",
+                                           llvm::cl::desc("check every generated function with the IR verifier "
+                                                          "(on by default in debug builds)"),
+                                           llvm::cl::init(CompilerOptions().VerifyFunctions),
+                                           llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> OnlyReachable("only-reachable",
+                                         llvm::cl::desc("parse each input completely, then only generate the functions "
+                                                        "that main, --export or a top-level statement can reach"),
+                                         llvm::cl::cat(CompilerCategory));
+static llvm::cl::list<std::string> Exports("export", llvm::cl::desc("functions other units call: kept by --only-reachable "
+                                                                   "and visible outside a --thinlto link"),
+                                           llvm::cl::value_desc("name,..."), llvm::cl::CommaSeparated,
+                                           llvm::cl::cat(CompilerCategory));
+// with --run the first positional is the program and the rest are its arguments
+// (put them after `--` if they look like options)
+static llvm::cl::opt<bool> Run("run", llvm::cl::desc("compile the first input in memory and run its main instead of "
+                                                     "writing an object file; later positionals are its arguments"),
+                               llvm::cl::cat(CompilerCategory));
+enum class EmitKind { Object, Bitcode };
+static llvm::cl::opt<EmitKind> Emit("emit", llvm::cl::desc("what to write for each input"),
+                                    llvm::cl::values(clEnumValN(EmitKind::Object, "obj", "an object file (default)"),
+                                                     clEnumValN(EmitKind::Bitcode, "bc",
+                                                                "bitcode for a --thinlto link, only pre-link "
+                                                                "optimized")),
+                                    llvm::cl::init(EmitKind::Object), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> ThinLTO("thinlto", llvm::cl::desc("link the bitcode inputs written with --emit=bc: import "
+                                                             "functions across them, then generate an object per "
+                                                             "input, -j at a time; only main and --export stay "
+                                                             "visible outside"),
+                                   llvm::cl::cat(CompilerCategory));
+// -O has to match between the two builds: the profile is matched to each
+// function by a hash of its control flow, which the pipeline before
+// instrumentation already changes
+static llvm::cl::opt<std::string> ProfileGenerate("profile-generate",
+                                                  llvm::cl::desc("count how often each branch is taken and write the "
+                                                                 "counts to this file (or $LLVM_PROFILE_FILE) when "
+                                                                 "the program exits"),
+                                                  llvm::cl::value_desc("path"), llvm::cl::ValueOptional,
+                                                  llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> ProfileUse("profile-use",
+                                             llvm::cl::desc("optimize for the counts in this profile, merged from "
+                                                            "--profile-generate runs with `llvm-profdata merge`"),
+                                             llvm::cl::value_desc("file.profdata"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> DebugInfo("g", llvm::cl::desc("emit DWARF line tables, so profilers and debuggers can map "
+                                                         "the generated code back to .ad lines"),
+                                     llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> Interactive("repl", llvm::cl::desc("read and run one entry at a time from standard input"),
+                                       llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> TimeReport("time-report", llvm::cl::desc("print where the compile time of each input went"),
+                                      llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<std::string> TraceFilename("trace", llvm::cl::desc("write a Chrome trace-event timeline of the "
+                                                                        "compile (chrome://tracing, Perfetto)"),
+                                                llvm::cl::value_desc("path"), llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<unsigned> TraceGranularity("trace-granularity",
+                                                llvm::cl::desc("leave spans shorter than this out of the trace"),
+                                                llvm::cl::value_desc("microseconds"), llvm::cl::init(500),
+                                                llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> DumpSource("dump-source", llvm::cl::desc("print the source before compiling"),
+                                      llvm::cl::cat(CompilerCategory));
+static llvm::cl::opt<bool> DumpTokens("dump-tokens", llvm::cl::desc("print the token table before compiling"),
+                                      llvm::cl::cat(CompilerCategory));
 
-        //printf("Parsed an extern\n");
-    } else {
-        // Skip token for error recovery.
-        Parser::getNextToken();
-    }
+// workers print their whole report at once so output from parallel jobs doesn't interleave
+static std::mutex OutputMutex;
+
+// a single input keeps writing to the fixed default path; several inputs each get <input>.<Extension>
+static std::string GetOutputPath(const std::string &InputPath, const char *DefaultPath, const char *Extension) {
+    if (InputFilenames.size() == 1)
+        return DefaultPath;
+    llvm::SmallString<128> Path(InputPath);
+    llvm::sys::path::replace_extension(Path, Extension);
+    return std::string(Path);
 }
 
-static void HandleTopLevelExpression() {
-    // Evaluate a top-level expression into an anonymous function.
-    if (auto StAST = Parser::ParseStatement()) {
-        if (auto *FnIR = StAST->codegen()) {
-            // fprintf(stderr, "Read top-level expr (statement):\n");
-            // FnIR->print(llvm::errs());
-            // fprintf(stderr, "\n");
-        }
-        // printf("Parsed a top-level expr (statement)\n");
-    } else {
-        // Skip token for error recovery.
-        Parser::getNextToken();
+static llvm::Optional<llvm::OptimizationLevel> GetOptimizationLevel() {
+    switch (OptLevel) {
+        case '0': return llvm::OptimizationLevel::O0;
+        case '1': return llvm::OptimizationLevel::O1;
+        case '2': return llvm::OptimizationLevel::O2;
+        case '3': return llvm::OptimizationLevel::O3;
+        case 's': return llvm::OptimizationLevel::Os;
+        case 'z': return llvm::OptimizationLevel::Oz;
+        default: return llvm::None;
     }
 }
 
-static void MainLoop() {
-    while (true) {
-        switch (Parser::CurrentToken.type) {
-            case Token::type::tok_eof:
-                return;
-            case Token::type::tok_func:
-                HandleDefinition();
-                break;
-            case Token::type::tok_extern:
-                HandleExtern();
-                break;
-            default:
-                if (Parser::CurrentToken.value == ";")
-                    Parser::getNextToken();
-                else {
-                    HandleTopLevelExpression();
-                }
+// the source has to stay mapped until codegen is done: every token views into it
+static std::unique_ptr<llvm::MemoryBuffer> LoadSource(const std::string &InputPath, CompileStats *Stats) {
+    PhaseTimer Timer(Stats, CompileStats::Read, InputPath);
+    // large files are mmap'd read-only; the buffer is null-terminated
+    auto FileOrErr = llvm::MemoryBuffer::getFile(InputPath);
+    if (!FileOrErr)
+        throw std::runtime_error("invalid file: " + FileOrErr.getError().message());
+    if (Stats)
+        Stats->SourceBytes = (*FileOrErr)->getBufferSize();
+    return std::move(*FileOrErr);
+}
+
+// lexes, parses, generates and optimizes the whole unit; the requested dumps go to OS
+static void BuildModule(CompilerInstance &CI, llvm::raw_ostream &OS) {
+    if (DumpSource)
+        OS << "SOURCE:\n---\n" << CI.Lex.Source << "\n---\n\n";
+
+    // lex everything once; the parser and the token dump both read the buffer
+    {
+        PhaseTimer Timer(CI.Stats, CompileStats::Lex);
+        CI.Lex.Tokenize();
+    }
+
+    if (DumpTokens) {
+        OS << "TOKENS:\n";
+
+        OS << "ROW:COL      TOKEN       TYPE\n";
+        for (const Token &Tok : CI.Lex.Tokens) {
+            if (Tok.type == Token::type::tok_eof)
                 break;
+            OS << llvm::format("%3d:%-3d %10.*s %10d\n",
+                               Tok.pos.row,
+                               Tok.pos.column,
+                               (int)Tok.value.size(),
+                               Tok.value.data(),
+                               Tok.type
+            );
         }
-        fflush(stdout);
-        fflush(stderr);
+        OS << "\n";
     }
-}
 
+    // initialize module
+    if (CI.InitializeModule())
+        throw std::runtime_error("failed to set up the target");
 
-int main(int argc, char **argv) {
-    if (argc < 2) {
-        std::cerr << "please specify a file to compile!\n" << argv[0] << " [path to file]\n" << std::flush;
-        exit(EXIT_FAILURE);
+    CI.MainLoop();
+    CI.OptimizeModule();
+
+    if (CI.Stats) {
+        // not counting the trailing tok_eof
+        CI.Stats->Tokens = CI.Lex.Tokens.size() - 1;
+        CI.Stats->ASTNodes = CI.AST.getNodeCount();
     }
+}
+
+static void PrintTimeReport(const std::string &InputPath, const CompileStats &Stats, llvm::raw_ostream &OS) {
+    OS << "\nTIME REPORT (" << InputPath << "):\n";
+    Stats.print(OS);
+    OS << "\n";
+}
 
-    std::ifstream ifs(argv[1]);
-    if (!ifs) {
-        std::cerr << "invalid file!" << std::endl;
+// compiles one input into an object file on the calling thread; returns false on error
+static bool CompileFile(const std::string &InputPath, const CompilerOptions &Options) {
+    std::string Report;
+    llvm::raw_string_ostream OS(Report);
+    bool Ok = true;
+    llvm::TimeTraceScope Trace("Compile", InputPath);
+
+    try {
+        CompileStats Stats;
+        std::unique_ptr<llvm::MemoryBuffer> SourceBuffer = LoadSource(InputPath, TimeReport ? &Stats : nullptr);
+        CompilerInstance CI(std::string_view(SourceBuffer->getBufferStart(), SourceBuffer->getBufferSize()),
+                            InputPath, Options);
+        CI.Stats = TimeReport ? &Stats : nullptr;
+        BuildModule(CI, OS);
+
+#ifdef DEBUG
+        std::string IRPath = GetOutputPath(InputPath, out_file, "ll");
+        CI.SaveModuleToFile(IRPath);
+        OS << "saved compiled LLVM IR to \"" << IRPath << "\"!\n";
+#endif
+        bool Bitcode = Options.EmitBitcode;
+        std::string OutputPath = !OutputFilename.empty() ? std::string(OutputFilename)
+                                 : Bitcode              ? GetOutputPath(InputPath, "out.bc", "bc")
+                                                        : GetOutputPath(InputPath, "out.o", "o");
+        if (Bitcode ? CI.SaveBitcodeToFile(OutputPath) : CI.SaveObjectToFile(OutputPath))
+            throw std::runtime_error("failed to write \"" + OutputPath + "\"");
+        OS << "saved " << (Bitcode ? "bitcode" : "object file") << " to \"" << OutputPath << "\"!\n";
+        if (TimeReport)
+            PrintTimeReport(InputPath, Stats, OS);
+    } catch (const std::exception &E) {
+        OS << InputPath << ": " << E.what() << "\n";
+        Ok = false;
     }
 
-    std::stringstream temp;
-    temp << ifs.rdbuf();
-    Lexer(temp.str());
+    std::lock_guard<std::mutex> Lock(OutputMutex);
+    (Ok ? std::cout : std::cerr) << OS.str() << std::flush;
+    return Ok;
+}
 
-    // Lexer(
-    //       //"extern puts(in : s1*) : s4;\n"
-    //       "extern printf(fmt : s1*, ...) : s4;"
-    //       "func main() : s4 {\n"
-    //       //"\tputs(\"hello world!\");\n"
-    //       "\tprintf(\"hello world!\");\n"
-    //       "\treturn 0;\n"
-    //       "}\n");
-    //       // "func thing(arg1 : s4, arg2 : s4) : s4 {\n"
-    //       // "\targ1 + arg2;\n"
-    //       // "\treturn arg1 + arg2 * 6.0;\n"
-    //       // "};\n"
-    //       // "\n"
-    //       // "thing(1.0, 2.0);"); // todo: fix function stuff bc this call
-    //                            // is nested within the function instead
-    //                            // of being outside
+// compiles one input in memory and calls its main on a JIT in this process;
+// returns main's exit code. nothing is written to disk and no linker is run.
+static int RunFile(const std::string &InputPath, llvm::ArrayRef<std::string> ProgramArgs,
+                   const CompilerOptions &Options) {
+    try {
+        CompileStats Stats;
+        std::unique_ptr<llvm::MemoryBuffer> SourceBuffer = LoadSource(InputPath, TimeReport ? &Stats : nullptr);
+        CompilerInstance CI(std::string_view(SourceBuffer->getBufferStart(), SourceBuffer->getBufferSize()),
+                            InputPath, Options);
+        CI.Stats = TimeReport ? &Stats : nullptr;
+        std::string Report;
+        llvm::raw_string_ostream OS(Report);
+        {
+            llvm::TimeTraceScope Trace("Compile", InputPath);
+            BuildModule(CI, OS);
+        }
+        // the JIT compiles main and everything it calls when it is looked up, before
+        // anything runs; that isn't split into phases
+        if (TimeReport)
+            PrintTimeReport(InputPath, Stats, OS);
+        std::cout << OS.str() << std::flush;
 
-    std::cout << "SOURCE:\n---\n" << Lexer::Source << "\n---\n" << std::endl;
+        llvm::TimeTraceScope Trace("Run", InputPath);
 
-    std::cout << "TOKENS:\n";
+        JITSession JIT;
+        JIT.addModule(CI.TakeModule());
+        int ExitCode = JIT.runMain(InputPath, ProgramArgs);
+        // the program wrote through this process's stdio
+        fflush(stdout);
+        return ExitCode;
+    } catch (const std::exception &E) {
+        std::cerr << InputPath << ": " << E.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
 
-    printf("%3s:%-3s %10s %10s\n", "ROW", "COL", "TOKEN", "TYPE");
-    fflush(stdout);
+int main(int argc, char **argv) {
+    llvm::cl::HideUnrelatedOptions(CompilerCategory);
+    llvm::cl::ParseCommandLineOptions(argc, argv, "abheek_lang compiler\n");
 
-    Token::InitBinOps();
+    if (Interactive != InputFilenames.empty()) {
+        std::cerr << (Interactive ? "--repl doesn't take input files\n" : "no input files\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!OutputFilename.empty() && !Run && InputFilenames.size() > 1) {
+        std::cerr << "-o can only be used with a single input file\n";
+        exit(EXIT_FAILURE);
+    }
+    if (TimeReport && Interactive) {
+        std::cerr << "--time-report only covers compiling input files\n";
+        exit(EXIT_FAILURE);
+    }
+    if (OnlyReachable && Interactive) {
+        std::cerr << "--only-reachable needs the whole input, which --repl never has\n";
+        exit(EXIT_FAILURE);
+    }
+    if (!Exports.empty() && !OnlyReachable && !ThinLTO) {
+        std::cerr << "--export only has an effect with --only-reachable or --thinlto\n";
+        exit(EXIT_FAILURE);
+    }
+    if (ThinLTO && (Run || Interactive || OnlyReachable || Emit != EmitKind::Object || !CacheDir.empty())) {
+        std::cerr << "--thinlto links bitcode into objects; it can't be combined with --run, --repl, "
+                     "--only-reachable, --emit or --cache-dir\n";
+        exit(EXIT_FAILURE);
+    }
+    if (Emit != EmitKind::Object && (Run || Interactive)) {
+        std::cerr << "--emit can't be used with --run or --repl, which don't write anything\n";
+        exit(EXIT_FAILURE);
+    }
+    bool Instrument = ProfileGenerate.getNumOccurrences() > 0;
+    if (Instrument && !ProfileUse.empty()) {
+        std::cerr << "--profile-generate and --profile-use can't be used together\n";
+        exit(EXIT_FAILURE);
+    }
+    if (Instrument && (Run || Interactive)) {
+        std::cerr << "--profile-generate can't be used with --run or --repl: the counts are written by the linked "
+                     "program\n";
+        exit(EXIT_FAILURE);
+    }
+    if ((Instrument || !ProfileUse.empty()) && (ThinLTO || !CacheDir.empty())) {
+        std::cerr << "profiles are applied while compiling the whole unit; --profile-generate and --profile-use "
+                     "can't be combined with --thinlto or --cache-dir\n";
+        exit(EXIT_FAILURE);
+    }
+    if (DebugInfo && (Run || Interactive || ThinLTO || !CacheDir.empty())) {
+        std::cerr << "-g describes the code generated for each input; it can't be combined with --run, --repl, "
+                     "--thinlto or --cache-dir\n";
+        exit(EXIT_FAILURE);
+    }
+    if (!TargetTriple.empty() && (Run || Interactive)) {
+        std::cerr << "--target can't be used with --run or --repl, which always run on the host\n";
+        exit(EXIT_FAILURE);
+    }
+    bool Native = March.getNumOccurrences() > 0;
+    if (Native && March != "native") {
+        std::cerr << "-march only takes 'native'; name any other CPU with -mcpu\n";
+        exit(EXIT_FAILURE);
+    }
+    if (Native && !MCPU.empty()) {
+        std::cerr << "-march=native already picks the CPU; it can't be combined with -mcpu\n";
+        exit(EXIT_FAILURE);
+    }
+    if (Native && !TargetTriple.empty() &&
+        llvm::Triple(llvm::Triple::normalize(TargetTriple)).getArch() !=
+                llvm::Triple(llvm::sys::getDefaultTargetTriple()).getArch()) {
+        std::cerr << "-march=native only makes sense for the host's architecture\n";
+        exit(EXIT_FAILURE);
+    }
+    if ((Native || !MCPU.empty() || !MAttrs.empty()) && (Run || Interactive)) {
+        std::cerr << "-march, -mcpu and -mattr can't be used with --run or --repl, which always generate code "
+                     "for the host CPU\n";
+        exit(EXIT_FAILURE);
+    }
 
-    Token currentTok;
-    while ((currentTok = Lexer::getTok()).type != Token::type::tok_eof) {
-        printf("%3d:%-3d %10s %10d\n",
-               currentTok.pos.row,
-               currentTok.pos.column,
-               currentTok.value.c_str(),
-               currentTok.type
-        );
+    CompilerOptions Options;
+    if (auto Level = GetOptimizationLevel())
+        Options.OptLevel = *Level;
+    else {
+        std::cerr << "invalid optimization level -O" << OptLevel << "\n";
+        exit(EXIT_FAILURE);
+    }
+    Options.VerifyFunctions = VerifyFunctions;
+    Options.TargetTriple = TargetTriple;
+    llvm::SubtargetFeatures Features(Native ? GetHostCPUFeatures() : "");
+    for (const std::string &Attr : MAttrs)
+        Features.AddFeature(Attr);
+    Options.CPU = Native ? llvm::sys::getHostCPUName().str() : std::string(MCPU);
+    Options.Features = Features.getString();
+    Options.CacheDir = CacheDir;
+    Options.OnlyReachable = OnlyReachable;
+    Options.Exports.assign(Exports.begin(), Exports.end());
+    Options.EmitBitcode = Emit == EmitKind::Bitcode;
+    Options.JIT = Run || Interactive;
+    Options.DebugInfo = DebugInfo;
+    if (Instrument) {
+        Options.ProfileGenerate = ProfileGenerate.empty() ? "default.profraw" : std::string(ProfileGenerate);
+        // the runtime only writes counters, not the value profiles (indirect call
+        // targets, memcpy sizes) compiler-rt would
+        auto &LLVMOptions = llvm::cl::getRegisteredOptions();
+        static_cast<llvm::cl::opt<bool> *>(LLVMOptions["disable-vp"])->setValue(true);
+    }
+    if (!ProfileUse.empty()) {
+        // the optimizer would only report a bad profile once per function, deep in the pipeline
+        auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfileUse);
+        if (!ReaderOrErr) {
+            std::cerr << ProfileUse << ": " << llvm::toString(ReaderOrErr.takeError())
+                      << " (raw .profraw files have to be merged with `llvm-profdata merge` first)\n";
+            exit(EXIT_FAILURE);
+        }
+        Options.ProfileUse = ProfileUse;
     }
-    printf("\n");
-    fflush(stdout);
 
-    Lexer::CharIdx = 0; // reset
+    // every thread that compiles records its own spans; they are merged into one file at exit
+    if (!TraceFilename.empty())
+        llvm::timeTraceProfilerInitialize(TraceGranularity, "abheek_lang");
+    auto WriteTrace = llvm::make_scope_exit([] {
+        if (TraceFilename.empty())
+            return;
+        if (llvm::Error Err = llvm::timeTraceProfilerWrite(TraceFilename, ""))
+            std::cerr << TraceFilename << ": " << llvm::toString(std::move(Err)) << "\n";
+        llvm::timeTraceProfilerCleanup();
+    });
 
-    // set parser precedences
-    Parser();
+    if (Interactive) {
+        try {
+            REPL Session(Options);
+            return Session.run(std::cin, std::cout);
+        } catch (const std::exception &E) {
+            std::cerr << E.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (Run)
+        return RunFile(InputFilenames.front(), llvm::ArrayRef<std::string>(InputFilenames).drop_front(), Options);
 
-    // initialize module
-    InitializeModule();
+    std::cout << "found target triple: "
+              << (TargetTriple.empty() ? llvm::sys::getDefaultTargetTriple() : TargetTriple) << '\n';
 
-    // Prime the first token.
-    Parser::getNextToken();
+    if (ThinLTO) {
+        std::vector<std::string> Outputs;
+        for (const std::string &InputPath : InputFilenames)
+            Outputs.push_back(OutputFilename.empty() ? GetOutputPath(InputPath, "out.o", "o") : OutputFilename);
+        try {
+            llvm::TimeTraceScope Trace("ThinLTO link");
+            ThinLTOLink(InputFilenames, Outputs, Options, Jobs);
+        } catch (const std::exception &E) {
+            std::cerr << E.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        for (const std::string &ObjectPath : Outputs)
+            std::cout << "saved object file to \"" << ObjectPath << "\"!\n";
+        return EXIT_SUCCESS;
+    }
 
-    MainLoop();
+    // every input gets its own CompilerInstance (context, module, ...), so they
+    // can be compiled on any worker without sharing state
+    std::atomic<bool> Failed = false;
+    llvm::ThreadPool Pool(llvm::hardware_concurrency(Jobs));
+    for (const std::string &InputPath : InputFilenames) {
+        Pool.async([&Failed, &InputPath, &Options] {
+            if (!TraceFilename.empty())
+                llvm::timeTraceProfilerInitialize(TraceGranularity, "abheek_lang");
+            if (!CompileFile(InputPath, Options))
+                Failed = true;
+            if (!TraceFilename.empty())
+                llvm::timeTraceProfilerFinishThread();
+        });
+    }
+    Pool.wait();
 
-#ifdef DEBUG
-    SaveModuleToFile(out_file);
-    std::cout << "saved compiled LLVM IR to \"" << out_file << "\"!\n" << std::flush;
-#endif
-    SaveObjectToFile("out.o");
-    std::cout << "saved object file to \"" << "out.o" << "\"!\n" << std::flush;
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
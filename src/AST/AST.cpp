@@ -3,211 +3,156 @@
 //
 
 #include "AST/AST.hpp"
-#include "llvm/IR/LegacyPassManager.h"
-#include "llvm/Support/FileSystem.h"
-#include "llvm/Support/Host.h"
-#include "llvm/MC/TargetRegistry.h"
-#include "llvm/Support/TargetSelect.h"
-#include "llvm/Target/TargetMachine.h"
-#include "llvm/Target/TargetOptions.h"
-
-#include <iostream>
+#include "Compiler/CompilerInstance.hpp"
+#include "Compiler/TargetClones.hpp"
 
+#include <cassert>
+#include <iterator>
 #include <utility>
+#include <llvm/ADT/StringSwitch.h>
 #include <llvm/IR/Verifier.h>
 
 using llvm::APFloat;
 using llvm::APInt;
 using llvm::BasicBlock;
+using llvm::CmpInst;
 using llvm::ConstantFP;
 using llvm::ConstantInt;
 using llvm::Function;
 using llvm::FunctionType;
+using llvm::Instruction;
 using llvm::IRBuilder;
 using llvm::LLVMContext;
 using llvm::Module;
 using llvm::Value;
-using llvm::TargetRegistry;
-
-// CODEGEN BEGIN
-static std::unique_ptr<LLVMContext> TheContext;
-static std::unique_ptr<IRBuilder<>> Builder;
-static std::unique_ptr<Module> TheModule;
-static std::map<std::string, Value *> CurrentFuncNamedValues;
-static std::map<std::string, Value *> GlobalNamedValues;
-
-int InitializeModule() {
-  // Open a new context and module.
-  TheContext = std::make_unique<LLVMContext>();
-  TheModule = std::make_unique<Module>("holy jit", *TheContext);
-
-  auto TargetTriple = llvm::sys::getDefaultTargetTriple();
-  std::cout << "found target triple: " << TargetTriple << '\n';
-
-  TheModule->setTargetTriple(TargetTriple);
-
-  // Create a new builder for the module.
-  Builder = std::make_unique<IRBuilder<>>(*TheContext);
-
-  return 0;
-}
-// CODEGEN END
-
-void SaveModuleToFile(const std::string &path) {
-  std::error_code EC;
-  llvm::raw_fd_ostream out(path, EC);
-  TheModule->print(out, nullptr);
-}
-
-int SaveObjectToFile(const std::string &path) {
-  std::error_code EC;
-  llvm::raw_fd_ostream out(path, EC, llvm::sys::fs::OF_None);
-  llvm::legacy::PassManager pass;
-  auto FileType = llvm::CGFT_ObjectFile;
-
-  using namespace llvm;
-  InitializeAllTargetInfos();
-  InitializeAllTargets();
-  InitializeAllTargetMCs();
-  InitializeAllAsmParsers();
-  InitializeAllAsmPrinters();
-
-  std::string Error;
-  auto Target = TargetRegistry::lookupTarget(TheModule->getTargetTriple(), Error);
-
-  // Print an error and exit if we couldn't find the requested target.
-  // This generally occurs if we've forgotten to initialise the
-  // TargetRegistry or we have a bogus target triple.
-  if (!Target) {
-    errs() << Error;
-    return 1;
-  }
-
-  auto CPU = "generic";
-  auto Features = "";
-
-  TargetOptions opt;
-  auto RM = Optional<Reloc::Model>();
-  auto TargetMachine = Target->createTargetMachine(TheModule->getTargetTriple(), CPU, Features, opt, RM);
-  TheModule->setDataLayout(TargetMachine->createDataLayout());
-
-  if (TargetMachine->addPassesToEmitFile(pass, out, nullptr, FileType)) {
-    errs() << "TargetMachine can't emit a file of this type";
-    return 1;
-  }
-
-  pass.run(*TheModule);
-  out.flush();
-  return 0;
-}
 
-ExprAST::~ExprAST() = default;
-
-NumberExprAST::NumberExprAST(std::string Value) : Value(std::move(Value)) {}
-Value *NumberExprAST::codegen() {
-  if (this->Value.find('.') != std::string::npos)
-    return ConstantFP::get(*TheContext, APFloat(stod(Value)));
-  // todo: contextual casting so it's not always floats
-  return ConstantInt::get(*TheContext,
-                          APInt(sizeof(long long) * 8, stoll(Value)));
+NumberExprAST::NumberExprAST(std::string_view Value)
+    : ExprAST(Kind::Number), Value(Value) {}
+Value *NumberExprAST::codegen(CompilerInstance &CI) {
+  // parse straight from the source text, at the width Sema picked for it
+  llvm::StringRef Text(this->Value.data(), this->Value.size());
+  llvm::Type *Ty = getType().GetLLVMType(*CI.TheContext);
+  if (Ty->isFloatingPointTy())
+    return ConstantFP::get(Ty, Text);
+  return ConstantInt::get(llvm::cast<llvm::IntegerType>(Ty), Text, 10);
 }
 
-StringExprAST::StringExprAST(std::string Value) : Value(std::move(Value)) {}
+StringExprAST::StringExprAST(std::string_view Value)
+    : ExprAST(Kind::String), Value(Value) {}
 
-llvm::Value *StringExprAST::codegen() {
-  return Builder->CreateGlobalStringPtr(llvm::StringRef(this->Value),
-                                        "string_lit", 0, TheModule.get());
+llvm::Value *StringExprAST::codegen(CompilerInstance &CI) {
+  return CI.Builder->CreateGlobalStringPtr(
+      llvm::StringRef(this->Value.data(), this->Value.size()), "string_lit", 0,
+      CI.TheModule.get());
 }
 
-/*Value *StringExprAST::codegen() {
+/*Value *StringExprAST::codegen(CompilerInstance &CI) {
     return StringLiteral::get(TheContext, APFloat(Value));
 }*/
 
-VariableExprAST::VariableExprAST(std::string Name) : Name(std::move(Name)) {}
-Value *VariableExprAST::codegen() {
+// a stack slot for a variable of the function being generated. slots all go at
+// the start of the entry block, which is where mem2reg and SROA look for the
+// ones they can promote to registers
+static llvm::AllocaInst *CreateEntryBlockAlloca(CompilerInstance &CI,
+                                                llvm::Type *Ty,
+                                                llvm::StringRef Name) {
+  BasicBlock &Entry =
+      CI.Builder->GetInsertBlock()->getParent()->getEntryBlock();
+  IRBuilder<> EntryBuilder(&Entry, Entry.begin());
+  return EntryBuilder.CreateAlloca(Ty, nullptr, Name);
+}
+
+VariableExprAST::VariableExprAST(Symbol Name)
+    : ExprAST(Kind::Variable), Name(Name) {}
+Value *VariableExprAST::codegen(CompilerInstance &CI) {
   // Look this variable up in the function.
-  Value *V = CurrentFuncNamedValues[Name];
+  Value *V = CI.NamedValues.lookup(Name);
   if (!V)
     throw std::runtime_error("codegen error: unknown variable name");
+  if (auto *Slot = llvm::dyn_cast<llvm::AllocaInst>(V))
+    return CI.Builder->CreateLoad(Slot->getAllocatedType(), Slot,
+                                  CI.Names.getName(Name));
   return V;
 }
 
-BinaryExprAST::BinaryExprAST(Token Op, std::unique_ptr<ExprAST> Left,
-                             std::unique_ptr<ExprAST> Right)
-    : Op(std::move(Op)), Left(std::move(Left)), Right(std::move(Right)) {}
-Value *BinaryExprAST::codegen() {
-  Value *L = Left->codegen();
-  Value *R = Right->codegen();
+// how each BinaryOp is lowered, indexed by opcode: either an arithmetic
+// instruction or a compare predicate, for integer and for floating point
+// operands. adding an operator only takes a new row here (and in Token).
+namespace {
+constexpr unsigned NoOpcode = ~0u;
+
+struct BinaryOpLowering {
+  bool IsCompare;
+  unsigned IntOpcode; // Instruction::BinaryOps or CmpInst::Predicate
+  unsigned FPOpcode;  // NoOpcode if there is no floating point form
+  const char *Name;
+};
+
+constexpr BinaryOpLowering BinaryOpLowerings[] = {
+    /* Mul */ {false, Instruction::Mul, Instruction::FMul, "mul_tmp"},
+    /* Div */ {false, Instruction::SDiv, Instruction::FDiv, "div_tmp"},
+    /* Rem */ {false, Instruction::SRem, Instruction::FRem, "rem_tmp"},
+    /* Add */ {false, Instruction::Add, Instruction::FAdd, "add_tmp"},
+    /* Sub */ {false, Instruction::Sub, Instruction::FSub, "sub_tmp"},
+    /* Shl */ {false, Instruction::Shl, NoOpcode, "shl_tmp"},
+    /* Shr */ {false, Instruction::AShr, NoOpcode, "shr_tmp"},
+    /* Lt */ {true, CmpInst::ICMP_SLT, CmpInst::FCMP_ULT, "lt_tmp"},
+    /* Le */ {true, CmpInst::ICMP_SLE, CmpInst::FCMP_ULE, "le_tmp"},
+    /* Gt */ {true, CmpInst::ICMP_SGT, CmpInst::FCMP_UGT, "gt_tmp"},
+    /* Ge */ {true, CmpInst::ICMP_SGE, CmpInst::FCMP_UGE, "ge_tmp"},
+};
+static_assert(std::size(BinaryOpLowerings) == (std::size_t)BinaryOp::None,
+              "every BinaryOp needs a lowering");
+} // namespace
+
+BinaryExprAST::BinaryExprAST(BinaryOp Op, ExprAST *Left, ExprAST *Right)
+    : ExprAST(Kind::Binary), Op(Op), Left(Left), Right(Right) {}
+
+bool BinaryExprAST::isCompare(BinaryOp Op) {
+  return BinaryOpLowerings[(int)Op].IsCompare;
+}
+
+bool BinaryExprAST::hasFloatingPointForm(BinaryOp Op) {
+  return BinaryOpLowerings[(int)Op].FPOpcode != NoOpcode;
+}
+
+Value *BinaryExprAST::codegen(CompilerInstance &CI) {
+  Value *L = Left->codegen(CI);
+  Value *R = Right->codegen(CI);
   if (!L || !R)
     return nullptr;
 
-  // casting literals
-  if (!L->hasName() != !R->hasName()) { // one or the other is constant
-    // if they aren't the same let llvm deal with the different types and error
-    if ((L->getType()->isIntegerTy() && R->getType()->isIntegerTy()) ||
-        (L->getType()->isFloatingPointTy() &&
-         R->getType()->isFloatingPointTy())) {
-      if (!L->hasName()) {
-        if (L->getType()->isIntegerTy())
-          L = Builder->CreateIntCast(L, R->getType(), true);
-        else if (L->getType()->isFloatingPointTy())
-          L = Builder->CreateFPCast(L, R->getType());
-      } else {
-        if (R->getType()->isIntegerTy())
-          R = Builder->CreateIntCast(R, L->getType(), true);
-        else if (R->getType()->isFloatingPointTy())
-          R = Builder->CreateFPCast(R, L->getType());
-      }
-    }
+  // Sema gave both operands the same type and made sure the operator takes it
+  const BinaryOpLowering &Lowering = BinaryOpLowerings[(int)Op];
+  // vectors work lane by lane, with the same instructions
+  unsigned Opcode = Left->getType().getElementType().isFloatingPoint()
+                        ? Lowering.FPOpcode
+                        : Lowering.IntOpcode;
+  if (Lowering.IsCompare) {
+    Value *Cmp = CI.Builder->CreateCmp((CmpInst::Predicate)Opcode, L, R,
+                                       Lowering.Name);
+    return CI.Builder->CreateZExt(Cmp, getType().GetLLVMType(*CI.TheContext),
+                                  "bool_tmp");
   }
+  return CI.Builder->CreateBinOp((Instruction::BinaryOps)Opcode, L, R,
+                                 Lowering.Name);
+}
 
-  // todo: string ops; done
-  // at this point they should be the same type
-  // so L type is same as R and checking one will give
-  // both
-  if (Op.value == "+") {
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateAdd(L, R, "add_tmp");
-    else
-      return Builder->CreateFAdd(L, R, "add_tmp");
-  } else if (Op.value == "-")
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateSub(L, R, "sub_tmp");
-    else
-      return Builder->CreateFSub(L, R, "sub_tmp");
-  else if (Op.value == "*")
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateMul(L, R, "mul_tmp");
-    else
-      return Builder->CreateFMul(L, R, "mul_tmp");
-  else if (Op.value == "/")
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateSDiv(L, R, "div_tmp");
-    else
-      return Builder->CreateFDiv(L, R, "div_tmp");
-  else if (Op.value == "<")
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateICmpSLT(L, R, "lt_tmp");
-    else
-      return Builder->CreateFCmpULT(L, R, "lt_tmp");
-  else if (Op.value == ">")
-    if (L->getType()->isIntegerTy())
-      return Builder->CreateICmpSGT(L, R, "gt_tmp");
-    else
-      return Builder->CreateFCmpUGT(L, R, "gt_tmp");
-  else
-    throw std::runtime_error("codegen error: unknown operator");
+void BinaryExprAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Left->collectCallees(Callees);
+  Right->collectCallees(Callees);
 }
 
-CallExprAST::CallExprAST(std::string Callee,
-                         std::vector<std::unique_ptr<ExprAST>> Args)
-    : Callee(std::move(Callee)), Args(std::move(Args)) {}
+CallExprAST::CallExprAST(Symbol Callee, llvm::MutableArrayRef<ExprAST *> Args)
+    : ExprAST(Kind::Call), Callee(Callee), Args(Args) {}
 
-Value *CallExprAST::codegen() {
-  // Look up the name in the global module table.
-  Function *CalleeF = TheModule->getFunction(Callee);
+Value *CallExprAST::codegen(CompilerInstance &CI) {
+  // Look up the name in the global function table.
+  Function *CalleeF = CI.GetFunction(Callee);
   if (!CalleeF) {
-    throw std::runtime_error("unknown function: \"" + Callee + "\"");
+    throw std::runtime_error("unknown function: \"" +
+                             CI.Names.getName(Callee).str() + "\"");
   }
 
   // If argument mismatch error.
@@ -217,60 +162,192 @@ Value *CallExprAST::codegen() {
                              std::to_string(CalleeF->arg_size()));
 
   std::vector<Value *> ArgsV;
-  for (auto &Arg : Args) {
-    ArgsV.push_back(Arg->codegen());
+  for (ExprAST *Arg : Args) {
+    ArgsV.push_back(Arg->codegen(CI));
     if (!ArgsV.back())
       return nullptr;
   }
 
+  // a function with clones is called through the ifunc that picks one
+  llvm::FunctionCallee Target = CalleeF;
+  if (llvm::GlobalIFunc *IFunc = CI.IFuncs.lookup(Callee))
+    Target = llvm::FunctionCallee(CalleeF->getFunctionType(), IFunc);
+
+  // the call itself is where its name is, whatever its arguments moved to
+  CI.EmitLocation(getLoc());
   if (CalleeF->getReturnType()->isVoidTy())
-    return Builder->CreateCall(CalleeF, ArgsV);
+    return CI.Builder->CreateCall(Target, ArgsV);
   else
-    return Builder->CreateCall(CalleeF, ArgsV, "call_tmp");
+    return CI.Builder->CreateCall(Target, ArgsV, "call_tmp");
+}
+
+void CallExprAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Callees.push_back(Callee);
+  for (ExprAST *Arg : Args)
+    Arg->collectCallees(Callees);
+}
+
+CastExprAST::CastExprAST(ExprAST *Operand, const Type &To)
+    : ExprAST(Kind::Cast), Operand(Operand) {
+  setType(To);
+  setLoc(Operand->getLoc());
+}
+
+Value *CastExprAST::codegen(CompilerInstance &CI) {
+  Value *V = Operand->codegen(CI);
+  if (!V)
+    return nullptr;
+
+  // a scalar becomes a vector by splatting it (Sema converted it to the
+  // element type first); vectors convert lane by lane
+  if (getType().isVector() && !Operand->getType().isVector())
+    return CI.Builder->CreateVectorSplat(getType().getLanes(), V, "splat_tmp");
+
+  Type From = Operand->getType().getElementType();
+  Type ToElement = getType().getElementType();
+  llvm::Type *To = getType().GetLLVMType(*CI.TheContext);
+  if (From.isInteger() && ToElement.isInteger())
+    return CI.Builder->CreateIntCast(V, To, true, "cast_tmp");
+  if (From.isInteger())
+    return CI.Builder->CreateSIToFP(V, To, "cast_tmp");
+  if (ToElement.isInteger())
+    return CI.Builder->CreateFPToSI(V, To, "cast_tmp");
+  return CI.Builder->CreateFPCast(V, To, "cast_tmp");
+}
+
+void CastExprAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Operand->collectCallees(Callees);
+}
+
+BuiltinExprAST::BuiltinExprAST(Builtin Op, llvm::ArrayRef<ExprAST *> Args,
+                               llvm::ArrayRef<int> Mask, const Type &T)
+    : ExprAST(Kind::Builtin), Op(Op), Args(Args), Mask(Mask) {
+  setType(T);
+}
+
+std::optional<BuiltinExprAST::Builtin>
+BuiltinExprAST::lookup(llvm::StringRef Name) {
+  return llvm::StringSwitch<std::optional<Builtin>>(Name)
+      .Case("splat", Builtin::Splat)
+      .Case("extract", Builtin::Extract)
+      .Case("insert", Builtin::Insert)
+      .Case("shuffle", Builtin::Shuffle)
+      .Case("reduceAdd", Builtin::ReduceAdd)
+      .Case("reduceMul", Builtin::ReduceMul)
+      .Case("reduceMin", Builtin::ReduceMin)
+      .Case("reduceMax", Builtin::ReduceMax)
+      .Case("load", Builtin::Load)
+      .Case("loadu", Builtin::LoadUnaligned)
+      .Case("store", Builtin::Store)
+      .Case("storeu", Builtin::StoreUnaligned)
+      .Default(std::nullopt);
+}
+
+Value *BuiltinExprAST::codegen(CompilerInstance &CI) {
+  llvm::SmallVector<Value *, 4> V;
+  for (ExprAST *Arg : Args) {
+    V.push_back(Arg->codegen(CI));
+    if (!V.back())
+      return nullptr;
+  }
+
+  // Sema checked the arguments and converted them to the types used here
+  auto &B = *CI.Builder;
+  bool IsFP = getType().getElementType().isFloatingPoint();
+  switch (Op) {
+  case Builtin::Splat:
+    return B.CreateVectorSplat(getType().getLanes(), V[0], "splat_tmp");
+  case Builtin::Extract:
+    return B.CreateExtractElement(V[0], V[1], "extract_tmp");
+  case Builtin::Insert:
+    return B.CreateInsertElement(V[0], V[1], V[2], "insert_tmp");
+  case Builtin::Shuffle:
+    return B.CreateShuffleVector(V[0], V[1], Mask, "shuffle_tmp");
+  case Builtin::ReduceAdd:
+  case Builtin::ReduceMul: {
+    bool IsAdd = Op == Builtin::ReduceAdd;
+    if (!IsFP)
+      return IsAdd ? B.CreateAddReduce(V[0]) : B.CreateMulReduce(V[0]);
+    // reassociation lets the lanes be combined as a tree of shuffles
+    // instead of one after the other
+    llvm::IRBuilderBase::FastMathFlagGuard Guard(B);
+    llvm::FastMathFlags FMF;
+    FMF.setAllowReassoc();
+    B.setFastMathFlags(FMF);
+    llvm::Type *ElemTy = getType().GetLLVMType(*CI.TheContext);
+    return IsAdd ? B.CreateFAddReduce(ConstantFP::getNegativeZero(ElemTy), V[0])
+                 : B.CreateFMulReduce(ConstantFP::get(ElemTy, 1.0), V[0]);
+  }
+  case Builtin::ReduceMin:
+    return IsFP ? B.CreateFPMinReduce(V[0]) : B.CreateIntMinReduce(V[0], true);
+  case Builtin::ReduceMax:
+    return IsFP ? B.CreateFPMaxReduce(V[0]) : B.CreateIntMaxReduce(V[0], true);
+  case Builtin::Load:
+  case Builtin::LoadUnaligned:
+  case Builtin::Store:
+  case Builtin::StoreUnaligned: {
+    Type VecType = Args[0]->getType().getPointeeType();
+    llvm::Type *VecTy = VecType.GetLLVMType(*CI.TheContext);
+    unsigned LaneBytes = VecType.getBitWidth() / 8;
+    bool Aligned = Op == Builtin::Load || Op == Builtin::Store;
+    llvm::Align Alignment(Aligned ? LaneBytes * VecType.getLanes() : LaneBytes);
+    Value *Addr = B.CreateInBoundsGEP(VecTy, V[0], V[1], "addr_tmp");
+    if (Op == Builtin::Load || Op == Builtin::LoadUnaligned)
+      return B.CreateAlignedLoad(VecTy, Addr, Alignment, "load_tmp");
+    return B.CreateAlignedStore(V[2], Addr, Alignment);
+  }
+  }
+  return nullptr;
+}
+
+void BuiltinExprAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  for (ExprAST *Arg : Args)
+    Arg->collectCallees(Callees);
 }
 
 PrototypeAST::PrototypeAST(
-    std::string Name,
-    std::vector<std::pair<std::string /* name */, Type /* type */>> Args,
+    Symbol Name, llvm::ArrayRef<std::pair<Symbol /* name */, Type /* type */>> Args,
     Type ReturnType, bool IsVarArg)
-    : Name(std::move(Name)), Args(std::move(Args)),
-      ReturnType(std::move(ReturnType)), IsVarArg(IsVarArg) {}
+    : Name(Name), Args(Args), IsVarArg(IsVarArg), ReturnType(ReturnType) {}
 
-llvm::Function *PrototypeAST::codegen() {
+llvm::Function *PrototypeAST::codegen(CompilerInstance &CI) {
   // todo: specify types for args
   std::vector<llvm::Type *> ArgTypes(Args.size());
   for (int i = 0; i < ArgTypes.size(); i++) {
-    if (auto ArgType = Args.at(i).second.GetLLVMType(*TheContext))
+    if (auto ArgType = Args[i].second.GetLLVMType(*CI.TheContext))
       ArgTypes.at(i) = ArgType;
     else
       return nullptr;
   }
-  auto RetType = this->ReturnType.GetLLVMType(*TheContext);
+  auto RetType = this->ReturnType.GetLLVMType(*CI.TheContext);
   if (!RetType)
     throw std::runtime_error("codegen error: invalid return type");
   FunctionType *FuncType = FunctionType::get(RetType, ArgTypes, this->IsVarArg);
-  Function *F = Function::Create(FuncType, Function::ExternalLinkage, Name,
-                                 TheModule.get());
+  Function *F = Function::Create(FuncType, Function::ExternalLinkage,
+                                 CI.Names.getName(Name), CI.TheModule.get());
+  CI.Functions.insert(Name, F);
 
   // Set names for all arguments.
   unsigned Idx = 0;
   for (auto &Arg : F->args()) {
-    Arg.setName(Args[Idx++].first);
+    Arg.setName(CI.Names.getName(Args[Idx++].first));
   }
 
   return F;
 }
 
-FunctionAST::FunctionAST(std::unique_ptr<PrototypeAST> Proto,
-                         std::unique_ptr<StatementAST> Body)
-    : Proto(std::move(Proto)), Body(std::move(Body)) {}
-
-llvm::Function *FunctionAST::codegen() {
-  // First, check for an existing function from a previous 'extern' declaration.
-  Function *TheFunction = TheModule->getFunction(Proto->getName());
+FunctionAST::FunctionAST(PrototypeAST *Proto, StatementAST *Body,
+                         llvm::ArrayRef<std::string_view> Clones)
+    : Proto(Proto), Body(Body), Clones(Clones) {}
 
-  if (!TheFunction)
-    TheFunction = Proto->codegen();
+llvm::Function *FunctionAST::codegen(CompilerInstance &CI) {
+  // First, check for an existing function from a previous 'extern' declaration;
+  // otherwise this prototype (registered by the caller) is the one that gets
+  // declared.
+  Function *TheFunction = CI.GetFunction(Proto->getName());
 
   if (!TheFunction)
     return nullptr;
@@ -278,36 +355,50 @@ llvm::Function *FunctionAST::codegen() {
   if (!TheFunction->empty())
     throw std::runtime_error("codegen error: cannot redefine function");
 
+  if (TheFunction->arg_size() != Proto->getArgs().size())
+    throw std::runtime_error(
+        "codegen error: definition doesn't match the declared arguments");
+
   // Create a new basic block to start insertion into.
-  BasicBlock *BB = BasicBlock::Create(*TheContext, "entry", TheFunction);
-  Builder->SetInsertPoint(BB);
+  BasicBlock *BB = BasicBlock::Create(*CI.TheContext, "entry", TheFunction);
+  CI.Builder->SetInsertPoint(BB);
+  CI.EmitSubprogram(TheFunction, Proto->getLoc());
 
-  // Record the function arguments in the NamedValues map.
-  CurrentFuncNamedValues.clear();
+  // Record the function arguments in a fresh scope of the NamedValues table.
+  // they can't be assigned to, so they need no stack slot
+  CI.NamedValues.pushScope();
+  unsigned Idx = 0;
   for (auto &Arg : TheFunction->args())
-    CurrentFuncNamedValues[Arg.getName().str()] = &Arg;
+    CI.NamedValues.insert(Proto->getArgs()[Idx++].first, &Arg);
 
-  Value *RetVal = Body->codegen();
+  Value *RetVal = Body->codegen(CI);
+  CI.NamedValues.popScope();
   if (true) {
-    if (TheFunction->getReturnType()->isIntegerTy()) {
-      if (RetVal->getType()->isFloatingPointTy())
-        RetVal = Builder->CreateFPToSI(RetVal, TheFunction->getReturnType());
-      else if (RetVal->getType()->isIntegerTy())
-        RetVal =
-            Builder->CreateIntCast(RetVal, TheFunction->getReturnType(), true);
-    } else if (TheFunction->getReturnType()->isFloatingPointTy()) {
-      if (RetVal->getType()->isIntegerTy())
-        RetVal = Builder->CreateSIToFP(RetVal, TheFunction->getReturnType());
-      else if (RetVal->getType()->isFloatingPointTy())
-        RetVal = Builder->CreateFPCast(RetVal, TheFunction->getReturnType());
-    }
-    Builder->CreateRet(RetVal);
+    // Sema already converted the returned value to the return type, and made
+    // sure there is one unless the function returns void
+    if (TheFunction->getReturnType()->isVoidTy())
+      CI.Builder->CreateRetVoid();
+    else
+      CI.Builder->CreateRet(RetVal);
+    CI.FinishSubprogram(TheFunction);
 
     // Validate the generated code, checking for consistency.
-    if(llvm::verifyFunction(*TheFunction)) {
+    if (CI.Options.VerifyFunctions) {
+      PhaseTimer Timer(CI.Stats, CompileStats::Verify);
+      if (llvm::verifyFunction(*TheFunction, &llvm::errs()))
         return nullptr;
     }
 
+    // calls from here on go through the ifunc
+    if (!Clones.empty() && !CI.Options.JIT) {
+      // the ThinLTO link would turn calls through it into calls to the resolver
+      if (CI.Options.EmitBitcode)
+        throw std::runtime_error(
+            "codegen error: functions with '@clones' can't go through a ThinLTO "
+            "link (--emit=bc)");
+      CI.IFuncs.insert(Proto->getName(),
+                       EmitTargetClones(*TheFunction, Clones, *CI.TheTargetMachine));
+    }
     return TheFunction;
   }
 
@@ -315,45 +406,237 @@ llvm::Function *FunctionAST::codegen() {
   return nullptr;
 }
 
-StatementAST::~StatementAST() = default;
+ExprStatementAST::ExprStatementAST(ExprAST *Expr)
+    : StatementAST(Kind::Expr), Expr(Expr) {}
 
-ExprStatementAST::ExprStatementAST(std::unique_ptr<ExprAST> Expr)
-    : Expr(std::move(Expr)) {
-  Type = "ExprStatement";
+llvm::Value *ExprStatementAST::codegen(CompilerInstance &CI) {
+  CI.EmitLocation(getLoc());
+  return this->Expr->codegen(CI);
 }
 
-llvm::Value *ExprStatementAST::codegen() { return this->Expr->codegen(); }
+void ExprStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Expr->collectCallees(Callees);
+}
 
 BlockStatementAST::BlockStatementAST(
-    std::vector<std::unique_ptr<StatementAST>> Statements)
-    : Statements(std::move(Statements)) {
-  Type = "BlockStatement";
-}
-
-llvm::Value *BlockStatementAST::codegen() {
-  for (const auto &S : Statements) {
-    if (auto C = S->codegen()) {
-      if (S->Type == "ReturnStatement") {
-        return C;
-      }
-    } else {
-      // return nullptr;
+    llvm::ArrayRef<StatementAST *> Statements)
+    : StatementAST(Kind::Block), Statements(Statements) {}
+
+llvm::Value *BlockStatementAST::codegen(CompilerInstance &CI) {
+  // variables declared in the block end with it
+  CI.NamedValues.pushScope();
+  Value *Result = nullptr;
+  for (StatementAST *S : Statements) {
+    Value *C = S->codegen(CI);
+    if (S->getKind() == Kind::Block || S->getKind() == Kind::While ||
+        S->getKind() == Kind::For) {
+      // Sema only lets a return be a direct statement of the function's body,
+      // so a nested block has no value, and a loop has none at all
+      assert(!C && "return inside a nested block");
+      continue;
+    }
+    if (!C)
       throw std::runtime_error("codegen error: failed to compile function body");
+    if (S->getKind() == Kind::Return) {
+      Result = C;
+      break;
     }
   }
-  return nullptr;
+  CI.NamedValues.popScope();
+  return Result;
+}
+
+void BlockStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  for (StatementAST *S : Statements)
+    S->collectCallees(Callees);
+}
+
+ReturnStatementAST::ReturnStatementAST(ExprAST *Argument)
+    : StatementAST(Kind::Return), Argument(Argument) {}
+
+llvm::Value *ReturnStatementAST::codegen(CompilerInstance &CI) {
+  CI.EmitLocation(getLoc());
+  return this->Argument->codegen(CI);
+}
+
+void ReturnStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Argument->collectCallees(Callees);
+}
+
+VarDeclStatementAST::VarDeclStatementAST(Symbol Name, Type VarType,
+                                         ExprAST *Init)
+    : StatementAST(Kind::VarDecl), Name(Name), VarType(VarType), Init(Init) {}
+
+llvm::Value *VarDeclStatementAST::codegen(CompilerInstance &CI) {
+  CI.EmitLocation(getLoc());
+  // the initializer can't see the variable it initializes
+  Value *InitVal = nullptr;
+  llvm::Type *Ty = VarType.GetLLVMType(*CI.TheContext);
+  if (Init) {
+    if (!(InitVal = Init->codegen(CI)))
+      return nullptr;
+  } else {
+    InitVal = llvm::Constant::getNullValue(Ty);
+  }
+
+  llvm::AllocaInst *Slot =
+      CreateEntryBlockAlloca(CI, Ty, CI.Names.getName(Name));
+  CI.Builder->CreateStore(InitVal, Slot);
+  CI.NamedValues.insert(Name, Slot);
+  return Slot;
+}
+
+void VarDeclStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  if (Init)
+    Init->collectCallees(Callees);
+}
+
+AssignStatementAST::AssignStatementAST(Symbol Name, ExprAST *Value)
+    : StatementAST(Kind::Assign), Name(Name), Value(Value) {}
+
+llvm::Value *AssignStatementAST::codegen(CompilerInstance &CI) {
+  CI.EmitLocation(getLoc());
+  // Sema only lets local variables be assigned to, and they all have a slot
+  auto *Slot =
+      llvm::dyn_cast_or_null<llvm::AllocaInst>(CI.NamedValues.lookup(Name));
+  if (!Slot)
+    throw std::runtime_error("codegen error: unknown variable name");
+  llvm::Value *V = Value->codegen(CI);
+  if (!V)
+    return nullptr;
+  CI.Builder->CreateStore(V, Slot);
+  return V;
+}
+
+void AssignStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Value->collectCallees(Callees);
+}
+
+// attaches a loop's hints to the branch that closes it, as the distinct,
+// self-referencing llvm.loop node the loop passes look for
+static void AddLoopMetadata(CompilerInstance &CI, llvm::BranchInst *Latch,
+                            const LoopHints &Hints) {
+  LLVMContext &Ctx = *CI.TheContext;
+  auto Hint = [&](llvm::StringRef Name, llvm::Constant *V) -> llvm::Metadata * {
+    if (!V)
+      return llvm::MDNode::get(Ctx, llvm::MDString::get(Ctx, Name));
+    return llvm::MDNode::get(Ctx, {llvm::MDString::get(Ctx, Name),
+                                   llvm::ConstantAsMetadata::get(V)});
+  };
+
+  llvm::SmallVector<llvm::Metadata *, 4> Ops = {nullptr}; // the node itself
+  if (Hints.VectorizeWidth) {
+    // a width of 1 is how llvm spells "don't vectorize"
+    Ops.push_back(Hint("llvm.loop.vectorize.width",
+                       CI.Builder->getInt32(Hints.VectorizeWidth)));
+    if (Hints.VectorizeWidth > 1)
+      Ops.push_back(
+          Hint("llvm.loop.vectorize.enable", CI.Builder->getTrue()));
+  }
+  if (Hints.UnrollCount == 1)
+    Ops.push_back(Hint("llvm.loop.unroll.disable", nullptr));
+  else if (Hints.UnrollCount)
+    Ops.push_back(Hint("llvm.loop.unroll.count",
+                       CI.Builder->getInt32(Hints.UnrollCount)));
+  if (Ops.size() == 1)
+    return;
+
+  llvm::MDNode *Loop = llvm::MDNode::getDistinct(Ctx, Ops);
+  Loop->replaceOperandWith(0, Loop);
+  Latch->setMetadata(llvm::LLVMContext::MD_loop, Loop);
+}
+
+// lowers a loop to the shape LLVM's loop passes recognise: the block before it
+// is the preheader, the header tests Cond, the body falls through to a single
+// latch that runs Step and is the only branch back to the header. the loop's
+// own branches are put at Loc, the keyword that starts it
+static void EmitLoop(CompilerInstance &CI, position Loc, ExprAST *Cond,
+                     StatementAST *Step, StatementAST *Body,
+                     const LoopHints &Hints) {
+  LLVMContext &Ctx = *CI.TheContext;
+  Function *F = CI.Builder->GetInsertBlock()->getParent();
+  BasicBlock *Header = BasicBlock::Create(Ctx, "loop_header", F);
+  BasicBlock *BodyBB = BasicBlock::Create(Ctx, "loop_body");
+  BasicBlock *Latch = BasicBlock::Create(Ctx, "loop_latch");
+  BasicBlock *Exit = BasicBlock::Create(Ctx, "loop_exit");
+
+  CI.EmitLocation(Loc);
+  CI.Builder->CreateBr(Header);
+  CI.Builder->SetInsertPoint(Header);
+  if (Cond) {
+    // Sema made sure the condition is an integer; anything but 0 is true
+    Value *C = Cond->codegen(CI);
+    if (!C)
+      throw std::runtime_error(
+          "codegen error: failed to compile loop condition");
+    Value *IsTrue = CI.Builder->CreateICmpNE(
+        C, llvm::Constant::getNullValue(C->getType()), "loop_cond");
+    CI.Builder->CreateCondBr(IsTrue, BodyBB, Exit);
+  } else {
+    CI.Builder->CreateBr(BodyBB);
+  }
+
+  BodyBB->insertInto(F);
+  CI.Builder->SetInsertPoint(BodyBB);
+  Body->codegen(CI);
+  CI.EmitLocation(Loc);
+  CI.Builder->CreateBr(Latch);
+
+  Latch->insertInto(F);
+  CI.Builder->SetInsertPoint(Latch);
+  if (Step) {
+    Step->codegen(CI);
+    CI.EmitLocation(Loc);
+  }
+  AddLoopMetadata(CI, CI.Builder->CreateBr(Header), Hints);
+
+  Exit->insertInto(F);
+  CI.Builder->SetInsertPoint(Exit);
 }
 
-ReturnStatementAST::ReturnStatementAST(std::unique_ptr<ExprAST> Argument)
-    : Argument(std::move(Argument)) {
-  Type = "ReturnStatement";
+WhileStatementAST::WhileStatementAST(ExprAST *Cond, StatementAST *Body,
+                                     LoopHints Hints)
+    : StatementAST(Kind::While), Cond(Cond), Body(Body), Hints(Hints) {}
+
+llvm::Value *WhileStatementAST::codegen(CompilerInstance &CI) {
+  EmitLoop(CI, getLoc(), Cond, nullptr, Body, Hints);
+  return nullptr;
 }
 
-llvm::Value *ReturnStatementAST::codegen() { return this->Argument->codegen(); }
+void WhileStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  Cond->collectCallees(Callees);
+  Body->collectCallees(Callees);
+}
 
-VarDeclStatementAST::VarDeclStatementAST(std::unique_ptr<ExprAST> Var,
-                                         std::string Type)
-    : Var(std::move(Var)), Type(std::move(Type)) {}
+ForStatementAST::ForStatementAST(StatementAST *Init, ExprAST *Cond,
+                                 StatementAST *Step, StatementAST *Body,
+                                 LoopHints Hints)
+    : StatementAST(Kind::For), Init(Init), Cond(Cond), Step(Step), Body(Body),
+      Hints(Hints) {}
+
+llvm::Value *ForStatementAST::codegen(CompilerInstance &CI) {
+  // a variable declared by Init is the loop's
+  CI.NamedValues.pushScope();
+  if (Init)
+    Init->codegen(CI);
+  EmitLoop(CI, getLoc(), Cond, Step, Body, Hints);
+  CI.NamedValues.popScope();
+  return nullptr;
+}
 
-// todo
-llvm::Value *VarDeclStatementAST::codegen() { return nullptr; }
+void ForStatementAST::collectCallees(
+    llvm::SmallVectorImpl<Symbol> &Callees) const {
+  if (Init)
+    Init->collectCallees(Callees);
+  if (Cond)
+    Cond->collectCallees(Callees);
+  if (Step)
+    Step->collectCallees(Callees);
+  Body->collectCallees(Callees);
+}
@@ -0,0 +1,112 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "AST/Type.hpp"
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/DerivedTypes.h>
+
+llvm::Type *Type::GetLLVMType(llvm::LLVMContext &Ctx) const {
+    if (!isValid())
+        return nullptr;
+    if (N->LLVMType)
+        return N->LLVMType;
+
+    llvm::Type *T = nullptr;
+    switch (N->K) {
+        case Kind::Void:
+            T = llvm::Type::getVoidTy(Ctx);
+            break;
+        case Kind::Integer:
+            T = llvm::Type::getIntNTy(Ctx, N->BitWidth);
+            break;
+        case Kind::FloatingPoint:
+            T = N->BitWidth == 32 ? llvm::Type::getFloatTy(Ctx) : llvm::Type::getDoubleTy(Ctx);
+            break;
+        case Kind::Pointer:
+            T = Type(N->Inner).GetLLVMType(Ctx)->getPointerTo();
+            break;
+        case Kind::Vector:
+            T = llvm::FixedVectorType::get(Type(N->Inner).GetLLVMType(Ctx), N->Lanes);
+            break;
+        case Kind::Invalid:
+            break;
+    }
+    return N->LLVMType = T;
+}
+
+TypeTable::TypeTable() {
+    Void = intern("void");
+    Integers[0] = intern("s1");
+    Integers[1] = intern("s2");
+    Integers[2] = intern("s4");
+    Integers[3] = intern("s8");
+    F4 = intern("f4");
+    F8 = intern("f8");
+}
+
+Type TypeTable::get(std::string_view Name, bool IsPointer) {
+    if (!IsPointer)
+        return intern(Name);
+    llvm::SmallString<16> Spelling(llvm::StringRef(Name.data(), Name.size()));
+    Spelling += '*';
+    return intern(Spelling.str());
+}
+
+Type TypeTable::getPointer(Type Pointee) {
+    return get(Pointee.getSpelling(), true);
+}
+
+Type TypeTable::getVector(Type Element, unsigned Lanes) {
+    return intern(std::string(Element.getSpelling()) + "x" + std::to_string(Lanes));
+}
+
+void TypeTable::resetLLVMTypes() {
+    for (auto &Entry : Nodes)
+        Entry.getValue().LLVMType = nullptr;
+}
+
+Type TypeTable::intern(std::string_view Spelling) {
+    llvm::StringRef Key(Spelling.data(), Spelling.size());
+    auto It = Nodes.find(Key);
+    if (It != Nodes.end())
+        return Type(&It->getValue());
+
+    // describing it may intern the pointee or element first
+    Type::Node N = describe(Spelling);
+    auto &Entry = *Nodes.try_emplace(Key, N).first;
+    Entry.getValue().Spelling = std::string_view(Entry.getKey().data(), Entry.getKey().size());
+    return Type(&Entry.getValue());
+}
+
+Type::Node TypeTable::describe(std::string_view Spelling) {
+    using Kind = Type::Kind;
+    Type::Node N = {Kind::Invalid, 0, 0, nullptr, {}, nullptr};
+
+    if (!Spelling.empty() && Spelling.back() == '*') {
+        Type Pointee = intern(Spelling.substr(0, Spelling.size() - 1));
+        if (Pointee.isNumeric() || Pointee.isVector())
+            N = {Kind::Pointer, 64, 0, Pointee.N, {}, nullptr};
+    } else if (Spelling == "void") {
+        N.K = Kind::Void;
+    } else if (Spelling.size() == 2 && (Spelling[0] == 's' || Spelling[0] == 'f')) {
+        unsigned Bytes = Spelling[1] - '0';
+        bool IsInteger = Spelling[0] == 's';
+        if (IsInteger ? (Bytes == 1 || Bytes == 2 || Bytes == 4 || Bytes == 8) : (Bytes == 4 || Bytes == 8))
+            N = {IsInteger ? Kind::Integer : Kind::FloatingPoint, Bytes * 8, 0, nullptr, {}, nullptr};
+    } else if (Spelling.size() >= 4 && Spelling[2] == 'x' && Spelling[3] != '0') {
+        Type Element = intern(Spelling.substr(0, 2));
+        unsigned Lanes = 0;
+        for (char C : Spelling.substr(3)) {
+            if (C < '0' || C > '9' || Lanes > Type::MaxLanes) {
+                Lanes = 0;
+                break;
+            }
+            Lanes = Lanes * 10 + (C - '0');
+        }
+        if (Element.isNumeric() && Lanes >= 2 && Lanes <= Type::MaxLanes && !(Lanes & (Lanes - 1)))
+            N = {Kind::Vector, Element.getBitWidth(), Lanes, Element.N, {}, nullptr};
+    }
+    return N;
+}
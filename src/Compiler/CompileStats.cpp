@@ -0,0 +1,81 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/CompileStats.hpp"
+
+#include <algorithm>
+
+#include "llvm/Support/Format.h"
+
+llvm::StringRef CompileStats::getPhaseName(Phase P) {
+    switch (P) {
+        case None: return "Other";
+        case Read: return "Read";
+        case Lex: return "Lex";
+        case Parse: return "Parse";
+        case Sema: return "Sema";
+        case Codegen: return "Codegen";
+        case Verify: return "Verify";
+        case Optimize: return "Optimize";
+        case Emit: return "Emit";
+        case NumPhases: break;
+    }
+    return "";
+}
+
+CompileStats::Phase CompileStats::enterPhase(Phase P) {
+    Clock::time_point Now = Clock::now();
+    Seconds[Current] += std::chrono::duration<double>(Now - Since).count();
+    Since = Now;
+    std::swap(Current, P);
+    return P;
+}
+
+// how many of the slowest functions the report lists
+static constexpr std::size_t SlowestFunctions = 10;
+
+void CompileStats::print(llvm::raw_ostream &OS) const {
+    double Total = 0;
+    for (unsigned P = Read; P < NumPhases; P++)
+        Total += Seconds[P];
+
+    OS << "PHASE          TIME (ms)       %\n";
+    for (unsigned P = Read; P < NumPhases; P++) {
+        OS << llvm::format("%-10s %13.3f %6.1f%%\n", getPhaseName((Phase)P).data(), Seconds[P] * 1e3,
+                           Total > 0 ? Seconds[P] * 100 / Total : 0.0);
+    }
+    OS << llvm::format("total      %13.3f\n\n", Total * 1e3);
+
+    std::uint64_t IRInstructions = 0;
+    for (const FunctionStats &F : Functions)
+        IRInstructions += F.IRInstructions;
+
+    OS << llvm::format("source bytes     %12llu (%.1f MB/s)\n", (unsigned long long)SourceBytes,
+                       Seconds[Lex] > 0 ? SourceBytes / Seconds[Lex] / 1e6 : 0.0);
+    OS << llvm::format("tokens           %12llu (%.2f M/s)\n", (unsigned long long)Tokens,
+                       Seconds[Lex] > 0 ? Tokens / Seconds[Lex] / 1e6 : 0.0);
+    OS << llvm::format("AST nodes        %12llu\n", (unsigned long long)ASTNodes);
+    OS << llvm::format("functions        %12zu\n", Functions.size());
+    if (SkippedFunctions)
+        OS << llvm::format("  unreachable    %12llu (not generated)\n", (unsigned long long)SkippedFunctions);
+    OS << llvm::format("IR instructions  %12llu (%.1f per function)\n", (unsigned long long)IRInstructions,
+                       Functions.empty() ? 0.0 : (double)IRInstructions / Functions.size());
+    OS << llvm::format("bytes emitted    %12llu\n", (unsigned long long)BytesEmitted);
+
+    if (Functions.empty())
+        return;
+
+    std::vector<const FunctionStats *> Slowest;
+    for (const FunctionStats &F : Functions)
+        Slowest.push_back(&F);
+    std::size_t Shown = std::min(Slowest.size(), SlowestFunctions);
+    std::partial_sort(Slowest.begin(), Slowest.begin() + Shown, Slowest.end(),
+                      [](const FunctionStats *A, const FunctionStats *B) { return A->Seconds > B->Seconds; });
+
+    OS << "\nSLOWEST TO GENERATE (ms)  IR INSTRUCTIONS  FUNCTION\n";
+    for (std::size_t i = 0; i < Shown; i++) {
+        OS << llvm::format("%24.3f %16u  ", Slowest[i]->Seconds * 1e3, Slowest[i]->IRInstructions)
+           << Slowest[i]->Name << "\n";
+    }
+}
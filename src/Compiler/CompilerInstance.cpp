@@ -0,0 +1,545 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/CompilerInstance.hpp"
+
+#include <cstdint>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include "Compiler/ProfileRuntime.hpp"
+#include "Compiler/Target.hpp"
+
+using llvm::IRBuilder;
+using llvm::LLVMContext;
+using llvm::Module;
+
+CompilerInstance::CompilerInstance(std::string_view Source, std::string ModuleName, CompilerOptions Options)
+        : Lex(Source, Names), Parse(Lex.Tokens, AST), ModuleName(std::move(ModuleName)), Options(Options),
+          Analysis(AST, Names, Prototypes) {
+    // at -O0 nearly all the time goes to the backend, which runs on the whole
+    // module either way; reading definitions back costs more than generating them
+    if (!this->Options.CacheDir.empty() && this->Options.OptLevel != llvm::OptimizationLevel::O0)
+        Cache = std::make_unique<FunctionCache>(this->Options.CacheDir);
+}
+
+// CODEGEN BEGIN
+int CompilerInstance::InitializeModule() {
+    // Open a new context and module. whatever is left of the previous module
+    // (e.g. after an error) has to go before the context it lives in
+    Builder.reset();
+    DBuilder.reset();
+    DebugUnit = nullptr;
+    DefinitionModules.clear();
+    SeparatelyDefined.clear();
+    TheModule.reset();
+    TheContext = std::make_unique<LLVMContext>();
+    AST.getTypes().resetLLVMTypes();
+    TheModule = std::make_unique<Module>(ModuleName, *TheContext);
+
+    // functions of an earlier module belong to its (now released) context
+    Functions.clear();
+    IFuncs.clear();
+    NamedValues.clear();
+    TopLevelExprs.clear();
+
+    // the target and its data layout are only set up for the first module of the thread
+    std::string Error;
+    CachedTarget *Target = GetCachedTarget(Options.TargetTriple, Options.CPU, Options.Features,
+                                           GetCodeGenOptLevel(Options.OptLevel), Error);
+
+    // Print an error and exit if we couldn't find the requested target.
+    // This generally occurs if we've forgotten to initialise the
+    // TargetRegistry or we have a bogus target triple.
+    if (!Target) {
+        llvm::errs() << Error << "\n";
+        return 1;
+    }
+
+    // the optimizer needs the target (cost model, data layout) before codegen runs
+    TheTargetMachine = Target->Machine.get();
+    TheModule->setTargetTriple(TheTargetMachine->getTargetTriple().str());
+    TheModule->setDataLayout(Target->Layout);
+
+    // Create a new builder for the module.
+    Builder = std::make_unique<IRBuilder<>>(*TheContext);
+
+    if (Options.DebugInfo) {
+        // the input path as it was given, relative to where the compiler ran
+        llvm::SmallString<128> Directory;
+        llvm::sys::fs::current_path(Directory);
+        DBuilder = std::make_unique<llvm::DIBuilder>(*TheModule);
+        DebugUnit = DBuilder->createCompileUnit(
+                llvm::dwarf::DW_LANG_C, DBuilder->createFile(ModuleName, Directory), "abheek_lang",
+                Options.OptLevel != llvm::OptimizationLevel::O0, "", 0, "",
+                llvm::DICompileUnit::LineTablesOnly);
+        TheModule->addModuleFlag(Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+        TheModule->addModuleFlag(Module::Warning, "Dwarf Version", 4);
+    }
+
+    return 0;
+}
+
+void CompilerInstance::EmitSubprogram(llvm::Function *F, position Loc) {
+    if (!DBuilder) {
+        // whatever the previous function left behind doesn't belong to this one
+        Builder->SetCurrentDebugLocation(llvm::DebugLoc());
+        return;
+    }
+    auto Flags = llvm::DISubprogram::SPFlagDefinition;
+    if (Options.OptLevel != llvm::OptimizationLevel::O0)
+        Flags |= llvm::DISubprogram::SPFlagOptimized;
+    // line tables need no types
+    llvm::DISubprogram *SP = DBuilder->createFunction(
+            DebugUnit->getFile(), F->getName(), "", DebugUnit->getFile(), Loc.row,
+            DBuilder->createSubroutineType(DBuilder->getOrCreateTypeArray({})), Loc.row,
+            llvm::DINode::FlagPrototyped, Flags);
+    F->setSubprogram(SP);
+    EmitLocation(Loc);
+}
+
+void CompilerInstance::FinishSubprogram(llvm::Function *F) {
+    if (DBuilder && F->getSubprogram())
+        DBuilder->finalizeSubprogram(F->getSubprogram());
+}
+
+void CompilerInstance::EmitLocation(position Loc) {
+    if (!DBuilder)
+        return;
+    // token columns count from 0, DWARF's from 1
+    llvm::DISubprogram *SP = Builder->GetInsertBlock()->getParent()->getSubprogram();
+    Builder->SetCurrentDebugLocation(llvm::DILocation::get(*TheContext, Loc.row, Loc.column + 1, SP));
+}
+// CODEGEN END
+
+// todo: add much better logging for parsed stuff
+void CompilerInstance::HandleDefinition() {
+    std::size_t FirstToken = Parse.TokenIdx;
+    auto *FnAST = [&] {
+        PhaseTimer Timer(Stats, CompileStats::Parse);
+        return Parse.ParseFuncDefinition();
+    }();
+    if (FnAST) {
+        llvm::ArrayRef<Token> Tokens = llvm::makeArrayRef(Lex.Tokens).slice(FirstToken, Parse.TokenIdx - FirstToken);
+        if (Options.OnlyReachable)
+            Deferred.push_back({FnAST, nullptr, Tokens});
+        else
+            CodegenDefinition(FnAST, Tokens);
+        //printf("Parsed a function definition.\n");
+    } else {
+        // Skip token for error recovery.
+        Parse.advance();
+    }
+}
+
+void CompilerInstance::CodegenDefinition(FunctionAST *Definition, llvm::ArrayRef<Token> Tokens) {
+    PrototypeAST *Proto = Definition->getProto();
+    llvm::StringRef Name = Names.getName(Proto->getName());
+    {
+        PhaseTimer Timer(Stats, CompileStats::Sema, Name);
+        Analysis.checkPrototype(Proto);
+        // registered first so the body can call itself; a cache hit generates
+        // nothing, but later code still has to be able to call it
+        Prototypes.insert(Proto->getName(), Proto);
+        Analysis.checkDefinition(Definition);
+    }
+
+    PhaseTimer Timer(Stats, CompileStats::Codegen, Name);
+    llvm::Function *FnIR = nullptr;
+    if (Cache) {
+        DefinitionModules.push_back(CodegenCachedDefinition(Definition, Tokens));
+        FnIR = DefinitionModules.back()->getFunction(Name);
+    } else if ((FnIR = Definition->codegen(*this))) {
+        // fprintf(stderr, "Read function definition:\n");
+        // FnIR->print(llvm::errs());
+        // fprintf(stderr, "\n");
+    }
+    if (Stats)
+        Stats->Functions.push_back({Name.str(), Timer.getSeconds(), FnIR ? FnIR->getInstructionCount() : 0});
+}
+
+void CompilerInstance::HandleExtern() {
+    auto *ProtoAST = [&] {
+        PhaseTimer Timer(Stats, CompileStats::Parse);
+        return Parse.ParseExtern();
+    }();
+    if (ProtoAST) {
+        {
+            PhaseTimer Timer(Stats, CompileStats::Sema, Names.getName(ProtoAST->getName()));
+            Analysis.checkPrototype(ProtoAST);
+        }
+        PhaseTimer Timer(Stats, CompileStats::Codegen, Names.getName(ProtoAST->getName()));
+        Prototypes.insert(ProtoAST->getName(), ProtoAST);
+        ProtoAST->codegen(*this);
+    } else {
+        // Skip token for error recovery.
+        Parse.advance();
+    }
+}
+
+void CompilerInstance::HandleTopLevelExpression() {
+    // Evaluate a top-level expression into an anonymous function.
+    auto *StAST = [&] {
+        PhaseTimer Timer(Stats, CompileStats::Parse);
+        return Parse.ParseStatement();
+    }();
+    if (StAST) {
+        if (Options.OnlyReachable)
+            Deferred.push_back({nullptr, StAST, {}});
+        else
+            CodegenTopLevelStatement(StAST);
+    } else {
+        // Skip token for error recovery.
+        Parse.advance();
+    }
+}
+
+llvm::Function *CompilerInstance::CodegenTopLevelStatement(StatementAST *Statement) {
+    using llvm::Function;
+    {
+        PhaseTimer Timer(Stats, CompileStats::Sema, "top-level statement");
+        Analysis.checkTopLevelStatement(Statement);
+    }
+    PhaseTimer Timer(Stats, CompileStats::Codegen, "top-level statement");
+
+    // the statement's type is only known once it has been generated, so it goes
+    // into a void wrapper first and moves to one with the right return type after.
+    // names start with '_' so they can never clash with an identifier
+    std::string Name = "__anon_expr" + std::to_string(AnonExprCount++);
+    // internal: nothing calls these from outside unless the REPL exports them
+    Function *Wrapper = Function::Create(llvm::FunctionType::get(Builder->getVoidTy(), false),
+                                         Function::InternalLinkage, Name, TheModule.get());
+    Builder->SetInsertPoint(llvm::BasicBlock::Create(*TheContext, "entry", Wrapper));
+    EmitSubprogram(Wrapper, Statement->getLoc());
+
+    NamedValues.pushScope();
+    llvm::Value *Result = Statement->codegen(*this);
+    NamedValues.popScope();
+
+    Function *F = Wrapper;
+    if (Result && !Result->getType()->isVoidTy()) {
+        F = Function::Create(llvm::FunctionType::get(Result->getType(), false), Function::InternalLinkage, "",
+                             TheModule.get());
+        F->takeName(Wrapper);
+        F->setSubprogram(Wrapper->getSubprogram());
+        F->getBasicBlockList().splice(F->end(), Wrapper->getBasicBlockList());
+        Wrapper->eraseFromParent();
+        Builder->CreateRet(Result);
+    } else {
+        Builder->CreateRetVoid();
+    }
+    FinishSubprogram(F);
+
+    if (Options.VerifyFunctions) {
+        PhaseTimer Timer(Stats, CompileStats::Verify);
+        if (llvm::verifyFunction(*F, &llvm::errs())) {
+            F->eraseFromParent();
+            return nullptr;
+        }
+    }
+    TopLevelExprs.push_back(F->getName().str());
+    return F;
+}
+
+void CompilerInstance::CodegenReachable() {
+    // every definition of each name: a call reaches all of them, so using a
+    // function that is defined twice still fails like it does without the option
+    llvm::DenseMap<Symbol, llvm::SmallVector<FunctionAST *, 1>> Definitions;
+    for (const DeferredItem &Item : Deferred) {
+        if (Item.Definition)
+            Definitions[Item.Definition->getProto()->getName()].push_back(Item.Definition);
+    }
+
+    llvm::SmallVector<Symbol, 64> Worklist;
+    Worklist.push_back(Names.intern("main"));
+    for (const std::string &Name : Options.Exports)
+        Worklist.push_back(Names.intern(Name));
+    for (const DeferredItem &Item : Deferred) {
+        if (Item.Statement)
+            Item.Statement->collectCallees(Worklist);
+    }
+
+    llvm::DenseSet<Symbol> Reachable;
+    while (!Worklist.empty()) {
+        Symbol Name = Worklist.pop_back_val();
+        if (!Reachable.insert(Name).second)
+            continue;
+        // nothing to follow for an extern or a name that is never defined
+        auto It = Definitions.find(Name);
+        if (It == Definitions.end())
+            continue;
+        for (FunctionAST *Definition : It->second)
+            Definition->getBody()->collectCallees(Worklist);
+    }
+
+    // in source order, so a call still only sees the functions defined above it
+    for (const DeferredItem &Item : Deferred) {
+        if (Item.Statement)
+            CodegenTopLevelStatement(Item.Statement);
+        else if (Reachable.count(Item.Definition->getProto()->getName()))
+            CodegenDefinition(Item.Definition, Item.Tokens);
+        else if (Stats)
+            Stats->SkippedFunctions++;
+    }
+    Deferred.clear();
+}
+
+std::unique_ptr<Module> CompilerInstance::CodegenCachedDefinition(FunctionAST *Definition,
+                                                                  llvm::ArrayRef<Token> Tokens) {
+    Symbol Name = Definition->getProto()->getName();
+    if (!SeparatelyDefined.insert(Name).second)
+        throw std::runtime_error("codegen error: cannot redefine function");
+
+    std::string Key = GetDefinitionKey(Tokens);
+    if (std::unique_ptr<Module> M = Cache->load(Key, *TheContext))
+        return M;
+
+    // generate into a module of its own for the time being; Functions refers to
+    // whichever module is current, so it starts over on each switch
+    auto M = std::make_unique<Module>(ModuleName, *TheContext);
+    M->setTargetTriple(TheModule->getTargetTriple());
+    M->setDataLayout(TheModule->getDataLayout());
+    llvm::Function *F;
+    {
+        std::swap(TheModule, M);
+        Functions.clear();
+        IFuncs.clear();
+        auto Restore = llvm::make_scope_exit([&] {
+            std::swap(TheModule, M);
+            Functions.clear();
+            IFuncs.clear();
+        });
+        F = Definition->codegen(*this);
+    }
+
+    // code that failed to verify is linked in like it would be without a cache, but never stored
+    RunOptimizationPipeline(*M);
+    if (F)
+        Cache->store(Key, *M);
+    return M;
+}
+
+std::string CompilerInstance::GetDefinitionKey(llvm::ArrayRef<Token> Tokens) {
+    llvm::SHA1 Hash;
+    // length-prefixed, so no two different sequences of strings hash the same
+    auto AddString = [&Hash](llvm::StringRef S) {
+        std::uint32_t Size = S.size();
+        Hash.update(llvm::ArrayRef<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(&Size), sizeof(Size)));
+        Hash.update(S);
+    };
+    auto AddType = [&AddString](const Type &T) {
+        AddString(llvm::StringRef(T.getSpelling().data(), T.getSpelling().size()));
+    };
+
+    // bump the version whenever the code generated for the same source changes
+    AddString("abheek_lang definition v3");
+    AddString(TheModule->getTargetTriple());
+    AddString(Options.CPU);
+    AddString(Options.Features);
+    AddString(Options.EmitBitcode ? "thinlto pre-link" : "");
+    AddString(std::to_string(Options.OptLevel.getSpeedupLevel()) + "/" +
+              std::to_string(Options.OptLevel.getSizeLevel()));
+
+    for (const Token &Tok : Tokens) {
+        AddString(std::to_string(Tok.type));
+        AddString(llvm::StringRef(Tok.value.data(), Tok.value.size()));
+    }
+
+    // calls only see a callee's signature, never its body
+    llvm::SmallPtrSet<PrototypeAST *, 8> Callees;
+    for (const Token &Tok : Tokens) {
+        if (Tok.type != Token::type::tok_ident)
+            continue;
+        PrototypeAST *Proto = Prototypes.lookup(Tok.sym);
+        if (!Proto || !Callees.insert(Proto).second)
+            continue;
+        AddString(Names.getName(Tok.sym));
+        for (const auto &Arg : Proto->getArgs())
+            AddType(Arg.second);
+        AddType(Proto->getReturnType());
+        AddString(Proto->isVarArg() ? "..." : "");
+    }
+
+    return llvm::toHex(Hash.final(), /* LowerCase */ true);
+}
+
+llvm::Function *CompilerInstance::GetFunction(Symbol Name) {
+    if (llvm::Function *F = Functions.lookup(Name))
+        return F;
+    if (PrototypeAST *Proto = Prototypes.lookup(Name)) {
+        // already declared in this module before Functions last started over
+        if (llvm::Function *F = TheModule->getFunction(Names.getName(Name))) {
+            Functions.insert(Name, F);
+            return F;
+        }
+        return Proto->codegen(*this);
+    }
+    return nullptr;
+}
+
+void CompilerInstance::MainLoop() {
+    while (true) {
+        switch (Parse.peek().type) {
+            case Token::type::tok_eof:
+                CodegenReachable();
+                return;
+            case Token::type::tok_func:
+                HandleDefinition();
+                break;
+            case Token::type::tok_extern:
+                HandleExtern();
+                break;
+            default:
+                if (Parse.peek().value == ";")
+                    Parse.advance();
+                else if (Parse.peek().value == "@" && Parse.peek(1).value == "clones")
+                    HandleDefinition(); // the one attribute a function can have
+                else {
+                    HandleTopLevelExpression();
+                }
+                break;
+        }
+    }
+}
+
+void CompilerInstance::OptimizeModule() {
+    PhaseTimer Timer(Stats, CompileStats::Optimize);
+    // the rest of the debug info (the compile unit's lists) is done once the
+    // whole module is, and the optimizer expects it to be
+    if (DBuilder)
+        DBuilder->finalize();
+    RunOptimizationPipeline(*TheModule);
+
+    // already optimized on their own when they were compiled
+    llvm::Linker L(*TheModule);
+    for (std::unique_ptr<Module> &M : DefinitionModules) {
+        if (L.linkInModule(std::move(M)))
+            throw std::runtime_error("codegen error: failed to link a separately compiled definition");
+    }
+    DefinitionModules.clear();
+    SeparatelyDefined.clear();
+
+    if (!Options.ProfileGenerate.empty() &&
+        L.linkInModule(CreateProfileRuntime(*TheContext, *TheModule, Options.ProfileGenerate)))
+        throw std::runtime_error("codegen error: failed to link the profile runtime");
+}
+
+void CompilerInstance::RunOptimizationPipeline(Module &M) {
+    // instrumenting is the one thing -O0 still runs a pipeline for
+    if (Options.OptLevel == llvm::OptimizationLevel::O0 && Options.ProfileGenerate.empty())
+        return;
+
+    PhaseTimer Timer(Stats, CompileStats::Optimize, M.getName());
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+
+    llvm::Optional<llvm::PGOOptions> PGO;
+    if (!Options.ProfileGenerate.empty())
+        PGO = llvm::PGOOptions(Options.ProfileGenerate, "", "", llvm::PGOOptions::IRInstr);
+    else if (!Options.ProfileUse.empty())
+        PGO = llvm::PGOOptions(Options.ProfileUse, "", "", llvm::PGOOptions::IRUse);
+
+    llvm::PassBuilder PB(TheTargetMachine, llvm::PipelineTuningOptions(), PGO);
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    if (Options.OptLevel == llvm::OptimizationLevel::O0) {
+        PB.buildO0DefaultPipeline(Options.OptLevel, Options.EmitBitcode).run(M, MAM);
+        return;
+    }
+    // for ThinLTO most of the work (inlining across modules among it) is left to the link step
+    llvm::ModulePassManager MPM = Options.EmitBitcode ? PB.buildThinLTOPreLinkDefaultPipeline(Options.OptLevel)
+                                                      : PB.buildPerModuleDefaultPipeline(Options.OptLevel);
+    MPM.run(M, MAM);
+}
+
+void CompilerInstance::SaveModuleToFile(const std::string &path) {
+    std::error_code EC;
+    llvm::raw_fd_ostream out(path, EC);
+    TheModule->print(out, nullptr);
+}
+
+int CompilerInstance::SaveObjectToFile(const std::string &path) {
+    std::error_code EC;
+    llvm::raw_fd_ostream out(path, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        llvm::errs() << path << ": " << EC.message() << "\n";
+        return 1;
+    }
+    llvm::legacy::PassManager pass;
+    auto FileType = llvm::CGFT_ObjectFile;
+
+    if (TheTargetMachine->addPassesToEmitFile(pass, out, nullptr, FileType)) {
+        llvm::errs() << "TargetMachine can't emit a file of this type";
+        return 1;
+    }
+
+    {
+        PhaseTimer Timer(Stats, CompileStats::Emit);
+        pass.run(*TheModule);
+        out.flush();
+    }
+    if (Stats)
+        Stats->BytesEmitted += out.tell();
+    return 0;
+}
+
+int CompilerInstance::SaveBitcodeToFile(const std::string &path) {
+    std::error_code EC;
+    llvm::raw_fd_ostream out(path, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        llvm::errs() << path << ": " << EC.message() << "\n";
+        return 1;
+    }
+
+    {
+        PhaseTimer Timer(Stats, CompileStats::Emit);
+        llvm::LoopAnalysisManager LAM;
+        llvm::FunctionAnalysisManager FAM;
+        llvm::CGSCCAnalysisManager CGAM;
+        llvm::ModuleAnalysisManager MAM;
+
+        llvm::PassBuilder PB(TheTargetMachine);
+        PB.registerModuleAnalyses(MAM);
+        PB.registerCGSCCAnalyses(CGAM);
+        PB.registerFunctionAnalyses(FAM);
+        PB.registerLoopAnalyses(LAM);
+        PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+        // the summary (call edges with their hotness, sizes, references) is all
+        // the link step reads to decide what to import where
+        llvm::ModulePassManager MPM;
+        MPM.addPass(llvm::BitcodeWriterPass(out, /* ShouldPreserveUseListOrder */ false,
+                                            /* EmitSummaryIndex */ true));
+        MPM.run(*TheModule, MAM);
+        out.flush();
+    }
+    if (Stats)
+        Stats->BytesEmitted += out.tell();
+    return 0;
+}
+
+llvm::orc::ThreadSafeModule CompilerInstance::TakeModule() {
+    // the builder refers to the context, so it can't outlive the handover
+    Builder.reset();
+    return {std::move(TheModule), std::move(TheContext)};
+}
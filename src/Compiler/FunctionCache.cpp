@@ -0,0 +1,66 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/FunctionCache.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+FunctionCache::FunctionCache(std::string Dir) : Dir(std::move(Dir)) {
+    if (std::error_code EC = llvm::sys::fs::create_directories(this->Dir))
+        throw std::runtime_error("can't create cache directory \"" + this->Dir + "\": " + EC.message());
+}
+
+std::string FunctionCache::getPath(llvm::StringRef Key) const {
+    llvm::SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path, Key + ".bc");
+    return std::string(Path);
+}
+
+std::unique_ptr<llvm::Module> FunctionCache::load(llvm::StringRef Key, llvm::LLVMContext &Ctx) {
+    auto BufferOrErr = llvm::MemoryBuffer::getFile(getPath(Key));
+    if (!BufferOrErr)
+        return nullptr;
+
+    auto ModuleOrErr = llvm::parseBitcodeFile((*BufferOrErr)->getMemBufferRef(), Ctx);
+    if (!ModuleOrErr) {
+        // a damaged entry is just a miss; storing the recompiled code replaces it
+        llvm::consumeError(ModuleOrErr.takeError());
+        return nullptr;
+    }
+    return std::move(*ModuleOrErr);
+}
+
+void FunctionCache::store(llvm::StringRef Key, const llvm::Module &M) {
+    std::string Path = getPath(Key);
+
+    // written under a temporary name and renamed into place, so a concurrent
+    // reader sees either no entry or a complete one
+    int FD;
+    llvm::SmallString<128> TempPath;
+    std::error_code EC = llvm::sys::fs::createUniqueFile(Path + ".tmp-%%%%%%", FD, TempPath);
+    if (!EC) {
+        llvm::raw_fd_ostream OS(FD, /* shouldClose */ true);
+        llvm::WriteBitcodeToFile(M, OS);
+        OS.close();
+        if (OS.has_error()) {
+            EC = OS.error();
+            OS.clear_error();
+        }
+        if (!EC)
+            EC = llvm::sys::fs::rename(TempPath, Path);
+        if (EC)
+            llvm::sys::fs::remove(TempPath);
+    }
+    if (EC)
+        llvm::errs() << "warning: can't write \"" << Path << "\" to the function cache: " << EC.message() << "\n";
+}
@@ -0,0 +1,53 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/JITSession.hpp"
+
+#include <stdexcept>
+
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h"
+
+#include "Compiler/Target.hpp"
+
+// ORC reports failures as llvm::Error; the rest of the compiler throws
+static void ThrowOnError(llvm::Error Err) {
+    if (Err)
+        throw std::runtime_error("jit error: " + llvm::toString(std::move(Err)));
+}
+
+template<typename T>
+static T ThrowOnError(llvm::Expected<T> ValOrErr) {
+    if (!ValOrErr)
+        ThrowOnError(ValOrErr.takeError());
+    return std::move(*ValOrErr);
+}
+
+JITSession::JITSession() {
+    // the JIT always targets the host, whatever else has been registered
+    InitializeHostTarget();
+
+    JIT = ThrowOnError(llvm::orc::LLJITBuilder().create());
+
+    JIT->getMainJITDylib().addGenerator(ThrowOnError(
+            llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(getDataLayout().getGlobalPrefix())));
+}
+
+const llvm::DataLayout &JITSession::getDataLayout() const {
+    return JIT->getDataLayout();
+}
+
+void JITSession::addModule(llvm::orc::ThreadSafeModule TSM) {
+    ThrowOnError(JIT->addIRModule(std::move(TSM)));
+}
+
+llvm::JITTargetAddress JITSession::lookup(llvm::StringRef Name) {
+    return ThrowOnError(JIT->lookup(Name)).getAddress();
+}
+
+int JITSession::runMain(llvm::StringRef ProgramName, llvm::ArrayRef<std::string> Args) {
+    // a `main` declared without parameters just ignores argc/argv
+    auto *Main = llvm::jitTargetAddressToFunction<int (*)(int, char *[])>(lookup("main"));
+    return llvm::orc::runAsMain(Main, Args, ProgramName);
+}
@@ -0,0 +1,155 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/ProfileRuntime.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+// what __llvm_profile_write_file in compiler-rt writes when nothing but
+// counters was collected: the raw header, then the data records, counters and
+// names exactly as the instrumented code laid them out in memory. the fields
+// after the header come in the order they are declared in InstrProfData.inc
+static const char *ProfileRuntimeSource = R"IR(
+@__llvm_profile_runtime = weak global i32 0
+@__abheek_profile_registered = weak global i1 false
+@__llvm_profile_raw_version = external global i64
+
+@__start___llvm_prf_data = extern_weak hidden global i8
+@__stop___llvm_prf_data = extern_weak hidden global i8
+@__start___llvm_prf_cnts = extern_weak hidden global i8
+@__stop___llvm_prf_cnts = extern_weak hidden global i8
+@__start___llvm_prf_names = extern_weak hidden global i8
+@__stop___llvm_prf_names = extern_weak hidden global i8
+
+@__abheek_profile_env = private constant [18 x i8] c"LLVM_PROFILE_FILE\00"
+@__abheek_profile_mode = private constant [3 x i8] c"wb\00"
+@__abheek_profile_zeros = private constant [8 x i8] zeroinitializer
+
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @__abheek_profile_init, i8* null }]
+
+declare i8* @getenv(i8*)
+declare i8* @fopen(i8*, i8*)
+declare i64 @fwrite(i8*, i64, i64, i8*)
+declare i32 @fclose(i8*)
+declare i32 @atexit(void ()*)
+
+define weak void @__abheek_profile_init() {
+entry:
+  %registered = load i1, i1* @__abheek_profile_registered
+  br i1 %registered, label %exit, label %register
+register:
+  store i1 true, i1* @__abheek_profile_registered
+  %result = call i32 @atexit(void ()* @__abheek_profile_write)
+  br label %exit
+exit:
+  ret void
+}
+
+define weak void @__abheek_profile_write() {
+entry:
+  %header = alloca [11 x i64], align 8
+  %env = call i8* @getenv(i8* getelementptr inbounds ([18 x i8], [18 x i8]* @__abheek_profile_env, i64 0, i64 0))
+  %unset = icmp eq i8* %env, null
+  %path = select i1 %unset, i8* getelementptr inbounds (@PATH_TYPE@, @PATH_TYPE@* @__abheek_profile_path, i64 0, i64 0), i8* %env
+  %file = call i8* @fopen(i8* %path, i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__abheek_profile_mode, i64 0, i64 0))
+  %failed = icmp eq i8* %file, null
+  br i1 %failed, label %exit, label %write
+write:
+  %data.begin = ptrtoint i8* @__start___llvm_prf_data to i64
+  %data.end = ptrtoint i8* @__stop___llvm_prf_data to i64
+  %data.bytes = sub i64 %data.end, %data.begin
+  %cnts.begin = ptrtoint i8* @__start___llvm_prf_cnts to i64
+  %cnts.end = ptrtoint i8* @__stop___llvm_prf_cnts to i64
+  %cnts.bytes = sub i64 %cnts.end, %cnts.begin
+  %names.begin = ptrtoint i8* @__start___llvm_prf_names to i64
+  %names.end = ptrtoint i8* @__stop___llvm_prf_names to i64
+  %names.bytes = sub i64 %names.end, %names.begin
+  %records = udiv i64 %data.bytes, @DATA_SIZE@
+  %counters = udiv i64 %cnts.bytes, 8
+  %counters.delta = sub i64 %cnts.begin, %data.begin
+  %version = load i64, i64* @__llvm_profile_raw_version
+  %magic.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 0
+  store i64 @MAGIC@, i64* %magic.field
+  %version.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 1
+  store i64 %version, i64* %version.field
+  %binary.ids.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 2
+  store i64 0, i64* %binary.ids.field
+  %data.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 3
+  store i64 %records, i64* %data.field
+  %padding.before.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 4
+  store i64 0, i64* %padding.before.field
+  %counters.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 5
+  store i64 %counters, i64* %counters.field
+  %padding.after.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 6
+  store i64 0, i64* %padding.after.field
+  %names.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 7
+  store i64 %names.bytes, i64* %names.field
+  %counters.delta.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 8
+  store i64 %counters.delta, i64* %counters.delta.field
+  %names.delta.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 9
+  store i64 %names.begin, i64* %names.delta.field
+  %value.kind.last.field = getelementptr inbounds [11 x i64], [11 x i64]* %header, i64 0, i64 10
+  store i64 @VALUE_KIND_LAST@, i64* %value.kind.last.field
+  %header.bytes = bitcast [11 x i64]* %header to i8*
+  %r0 = call i64 @fwrite(i8* %header.bytes, i64 8, i64 11, i8* %file)
+  %r1 = call i64 @fwrite(i8* @__start___llvm_prf_data, i64 1, i64 %data.bytes, i8* %file)
+  %r2 = call i64 @fwrite(i8* @__start___llvm_prf_cnts, i64 1, i64 %cnts.bytes, i8* %file)
+  %r3 = call i64 @fwrite(i8* @__start___llvm_prf_names, i64 1, i64 %names.bytes, i8* %file)
+  ; the names are padded to a multiple of 8 bytes
+  %names.bytes.neg = sub i64 0, %names.bytes
+  %names.padding = and i64 %names.bytes.neg, 7
+  %r4 = call i64 @fwrite(i8* getelementptr inbounds ([8 x i8], [8 x i8]* @__abheek_profile_zeros, i64 0, i64 0), i64 1, i64 %names.padding, i8* %file)
+  %closed = call i32 @fclose(i8* %file)
+  br label %exit
+exit:
+  ret void
+}
+)IR";
+
+std::unique_ptr<llvm::Module> CreateProfileRuntime(llvm::LLVMContext &Ctx, const llvm::Module &Instrumented,
+                                                   llvm::StringRef DefaultPath) {
+    llvm::Triple TT(Instrumented.getTargetTriple());
+    if (!TT.isOSBinFormatELF() || !TT.isArch64Bit())
+        throw std::runtime_error("codegen error: --profile-generate only supports 64-bit ELF targets");
+
+    // the default path as an IR string constant, every byte that isn't plain printable escaped
+    std::string PathConstant;
+    llvm::raw_string_ostream PathOS(PathConstant);
+    PathOS << "@__abheek_profile_path = private constant [" << DefaultPath.size() + 1 << " x i8] c\"";
+    for (unsigned char C : DefaultPath) {
+        if (llvm::isPrint(C) && C != '"' && C != '\\')
+            PathOS << C;
+        else
+            PathOS << '\\' << llvm::hexdigit(C >> 4) << llvm::hexdigit(C & 15);
+    }
+    PathOS << "\\00\"\n";
+
+    std::string Source = PathOS.str() + ProfileRuntimeSource;
+    auto Substitute = [&Source](llvm::StringRef Name, const std::string &Value) {
+        for (std::size_t Pos; (Pos = Source.find(Name.str())) != std::string::npos;)
+            Source.replace(Pos, Name.size(), Value);
+    };
+    Substitute("@PATH_TYPE@", "[" + std::to_string(DefaultPath.size() + 1) + " x i8]");
+    // IR integers are signed, and the magic has its top bit set
+    Substitute("@MAGIC@", std::to_string(static_cast<std::int64_t>(llvm::RawInstrProf::getMagic<std::uint64_t>())));
+    Substitute("@DATA_SIZE@", std::to_string(sizeof(llvm::RawInstrProf::ProfileData<std::uint64_t>)));
+    Substitute("@VALUE_KIND_LAST@", std::to_string(llvm::IPVK_Last));
+
+    llvm::SMDiagnostic Err;
+    std::unique_ptr<llvm::Module> Runtime = llvm::parseAssemblyString(Source, Err, Ctx);
+    if (!Runtime)
+        throw std::runtime_error("codegen error: profile runtime: " + Err.getMessage().str());
+    Runtime->setTargetTriple(Instrumented.getTargetTriple());
+    Runtime->setDataLayout(Instrumented.getDataLayout());
+    return Runtime;
+}
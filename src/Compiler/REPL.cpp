@@ -0,0 +1,176 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/REPL.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace {
+// how the value of a top-level statement comes back from its wrapper function
+enum class ResultKind {
+    None,
+    Bool,
+    Int8, Int16, Int32, Int64,
+    Float, Double,
+    String,
+    Pointer,
+};
+
+ResultKind GetResultKind(llvm::Type *Ty) {
+    if (Ty->isIntegerTy()) {
+        switch (Ty->getIntegerBitWidth()) {
+            case 1: return ResultKind::Bool;
+            case 8: return ResultKind::Int8;
+            case 16: return ResultKind::Int16;
+            case 32: return ResultKind::Int32;
+            case 64: return ResultKind::Int64;
+            default: return ResultKind::None;
+        }
+    }
+    if (Ty->isFloatTy())
+        return ResultKind::Float;
+    if (Ty->isDoubleTy())
+        return ResultKind::Double;
+    if (Ty->isPointerTy())
+        return Ty->getPointerElementType()->isIntegerTy(8) ? ResultKind::String : ResultKind::Pointer;
+    return ResultKind::None;
+}
+
+template<typename T>
+T Call(llvm::JITTargetAddress Addr) {
+    return llvm::jitTargetAddressToFunction<T (*)()>(Addr)();
+}
+
+// runs a wrapper and prints what it returned
+void RunAndPrint(llvm::JITTargetAddress Addr, ResultKind Kind, std::ostream &Out) {
+    switch (Kind) {
+        case ResultKind::None:
+            Call<void>(Addr);
+            return;
+        case ResultKind::Bool:
+            Out << ((Call<std::uint8_t>(Addr) & 1) ? "true" : "false");
+            break;
+        case ResultKind::Int8:
+            Out << (int)Call<std::int8_t>(Addr);
+            break;
+        case ResultKind::Int16:
+            Out << Call<std::int16_t>(Addr);
+            break;
+        case ResultKind::Int32:
+            Out << Call<std::int32_t>(Addr);
+            break;
+        case ResultKind::Int64:
+            Out << Call<std::int64_t>(Addr);
+            break;
+        case ResultKind::Float:
+            Out << Call<float>(Addr);
+            break;
+        case ResultKind::Double:
+            Out << Call<double>(Addr);
+            break;
+        case ResultKind::String:
+            Out << '"' << Call<const char *>(Addr) << '"';
+            break;
+        case ResultKind::Pointer:
+            Out << Call<const void *>(Addr);
+            break;
+    }
+    Out << '\n';
+}
+
+// whether Input is a whole entry: every brace closed and ending in ';' or '}'
+bool IsComplete(const std::string &Input) {
+    int Depth = 0;
+    bool InString = false;
+    char Last = 0;
+    for (std::size_t i = 0; i < Input.size(); i++) {
+        char C = Input[i];
+        if (InString) {
+            if (C == '\\')
+                i++;
+            else if (C == '"')
+                InString = false;
+            continue;
+        }
+        if (C == '"')
+            InString = true;
+        else if (C == '{')
+            Depth++;
+        else if (C == '}')
+            Depth--;
+        if (!isspace(C))
+            Last = C;
+    }
+    return !InString && Depth <= 0 && (Last == ';' || Last == '}');
+}
+} // namespace
+
+REPL::REPL(CompilerOptions Options) : CI("", "repl", Options) {}
+
+int REPL::run(std::istream &In, std::ostream &Out) {
+    std::string Input, Line;
+    while (true) {
+        Out << (Input.empty() ? "> " : "... ") << std::flush;
+        if (!std::getline(In, Line))
+            break;
+
+        // blank lines between entries are ignored
+        if (Input.empty() && Line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        Input += Line;
+        Input += '\n';
+        if (IsComplete(Input)) {
+            evaluate(std::move(Input), Out);
+            Input.clear();
+        }
+    }
+    Out << '\n';
+    return EXIT_SUCCESS;
+}
+
+void REPL::evaluate(std::string Input, std::ostream &Out) {
+    Inputs.push_back(std::move(Input));
+
+    // the prototypes an entry declares only stay if its module makes it into
+    // the JIT; otherwise later entries would call functions that don't exist
+    CI.Prototypes.pushScope();
+    bool Added = false;
+    try {
+        CI.Lex.reset(Inputs.back());
+        CI.Lex.Tokenize();
+        CI.Parse.reset();
+
+        if (CI.InitializeModule())
+            throw std::runtime_error("failed to set up the target");
+        CI.MainLoop();
+
+        // the wrappers are looked up by name once the module is in the JIT
+        std::vector<std::pair<std::string, ResultKind>> Results;
+        for (const std::string &Name : CI.TopLevelExprs) {
+            llvm::Function *F = CI.TheModule->getFunction(Name);
+            F->setLinkage(llvm::Function::ExternalLinkage);
+            Results.emplace_back(Name, GetResultKind(F->getReturnType()));
+        }
+
+        CI.OptimizeModule();
+        JIT.addModule(CI.TakeModule());
+        CI.Prototypes.keepScope();
+        Added = true;
+
+        for (const auto &[Name, Kind] : Results)
+            RunAndPrint(JIT.lookup(Name), Kind, Out);
+    } catch (const std::exception &E) {
+        if (!Added)
+            CI.Prototypes.popScope();
+        std::cerr << E.what() << "\n";
+    }
+    // whatever the entry printed through stdio comes before the next prompt
+    fflush(stdout);
+}
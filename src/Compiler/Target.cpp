@@ -0,0 +1,124 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/Target.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetOptions.h"
+
+llvm::CodeGenOpt::Level GetCodeGenOptLevel(const llvm::OptimizationLevel &Level) {
+    switch (Level.getSpeedupLevel()) {
+        case 0:
+            return llvm::CodeGenOpt::None;
+        case 1:
+            return llvm::CodeGenOpt::Less;
+        case 3:
+            return llvm::CodeGenOpt::Aggressive;
+        default:
+            return llvm::CodeGenOpt::Default;
+    }
+}
+
+void InitializeHostTarget() {
+    static std::once_flag HostTargetInitialized;
+    std::call_once(HostTargetInitialized, [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+    });
+}
+
+// registers whatever Triple needs; false if this build doesn't have it
+static bool InitializeTargetFor(const llvm::Triple &Triple) {
+    static const llvm::Triple Host(llvm::sys::getDefaultTargetTriple());
+    if (Triple.getArch() == Host.getArch()) {
+        InitializeHostTarget();
+        return true;
+    }
+#ifdef ABHEEK_LANG_ALL_TARGETS
+    // there's no registering a single target by name, so cross compiles pay for all of them
+    static std::once_flag AllTargetsInitialized;
+    std::call_once(AllTargetsInitialized, [] {
+        llvm::InitializeAllTargetInfos();
+        llvm::InitializeAllTargets();
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmParsers();
+        llvm::InitializeAllAsmPrinters();
+    });
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string GetHostCPUFeatures() {
+    llvm::StringMap<bool> HostFeatures;
+    if (!llvm::sys::getHostCPUFeatures(HostFeatures))
+        return "";
+    // the map's order would make the same host give different strings (and cache keys)
+    std::vector<std::string> Sorted;
+    for (const auto &Feature : HostFeatures)
+        Sorted.push_back((Feature.getValue() ? "+" : "-") + Feature.getKey().str());
+    std::sort(Sorted.begin(), Sorted.end(), [](const std::string &A, const std::string &B) {
+        return A.substr(1) < B.substr(1);
+    });
+
+    llvm::SubtargetFeatures Features;
+    for (const std::string &Feature : Sorted)
+        Features.AddFeature(Feature);
+    return Features.getString();
+}
+
+// an unknown CPU would only get a warning from the backend, and then be
+// ignored. so is an unknown feature, but that is as far as LLVM can tell
+static bool CheckCPU(const llvm::Target &Target, const std::string &Triple, const std::string &CPU,
+                     std::string &Error) {
+    std::unique_ptr<llvm::MCSubtargetInfo> STI(Target.createMCSubtargetInfo(Triple, "", ""));
+    if (STI->isCPUStringValid(CPU))
+        return true;
+    Error = "unknown CPU \"" + CPU + "\" for target \"" + Triple + "\"";
+    return false;
+}
+
+CachedTarget *GetCachedTarget(const std::string &Triple, const std::string &CPU, const std::string &Features,
+                              llvm::CodeGenOpt::Level Level, std::string &Error) {
+    std::string Normalized = Triple.empty() ? llvm::sys::getDefaultTargetTriple() : llvm::Triple::normalize(Triple);
+    std::string CPUName = CPU.empty() ? "generic" : CPU;
+
+    thread_local std::map<std::tuple<std::string, std::string, std::string, llvm::CodeGenOpt::Level>, CachedTarget>
+            Cache;
+    auto Key = std::make_tuple(Normalized, CPUName, Features, Level);
+    auto It = Cache.find(Key);
+    if (It != Cache.end())
+        return &It->second;
+
+    if (!InitializeTargetFor(llvm::Triple(Normalized))) {
+        Error = "no support for target \"" + Normalized + "\" in this build (only the host's)";
+        return nullptr;
+    }
+    auto *Target = llvm::TargetRegistry::lookupTarget(Normalized, Error);
+    if (!Target || !CheckCPU(*Target, Normalized, CPUName, Error))
+        return nullptr;
+
+    llvm::TargetOptions opt;
+    auto RM = llvm::Optional<llvm::Reloc::Model>();
+    std::unique_ptr<llvm::TargetMachine> Machine(
+            Target->createTargetMachine(Normalized, CPUName, Features, opt, RM, llvm::None, Level));
+    llvm::DataLayout Layout = Machine->createDataLayout();
+
+    return &Cache.emplace(std::move(Key), CachedTarget{std::move(Machine), std::move(Layout)}).first->second;
+}
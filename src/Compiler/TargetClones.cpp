@@ -0,0 +1,140 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/TargetClones.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/X86TargetParser.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+namespace {
+// one body the resolver can pick
+struct Clone {
+    std::string Suffix;
+    std::string CPU;
+    std::string Features;
+    // the libgcc __cpu_model/__cpu_features2 bits that have to be set
+    std::uint64_t Mask;
+    unsigned Priority;
+};
+} // namespace
+
+// the features libgcc's __cpu_indicator_init detects, which are the only ones a
+// resolver can test; the enum value is the bit that stands for it
+static const llvm::StringMap<llvm::X86::ProcessorFeatures> &GetTestableFeatures() {
+    static const llvm::StringMap<llvm::X86::ProcessorFeatures> Features = {
+#define X86_FEATURE_COMPAT(ENUM, STR, PRIORITY) {STR, llvm::X86::FEATURE_##ENUM},
+#include "llvm/Support/X86TargetParser.def"
+    };
+    return Features;
+}
+
+static Clone DescribeClone(llvm::StringRef Target, const llvm::TargetMachine &TM) {
+    const auto &Testable = GetTestableFeatures();
+    Clone C = {"", TM.getTargetCPU().str(), TM.getTargetFeatureString().str(), 0, 0};
+    auto AddTest = [&](llvm::X86::ProcessorFeatures Feature) {
+        C.Mask |= std::uint64_t(1) << Feature;
+        C.Priority = std::max(C.Priority, llvm::X86::getFeaturePriority(Feature));
+    };
+
+    if (Target.consume_front("arch=")) {
+        if (llvm::X86::parseArchX86(Target, /* Only64Bit */ true) == llvm::X86::CK_None)
+            throw std::runtime_error("codegen error: unknown CPU '" + Target.str() + "' in '@clones'");
+        llvm::SmallVector<llvm::StringRef, 32> CPUFeatures;
+        llvm::X86::getFeaturesForCPU(Target, CPUFeatures);
+        for (llvm::StringRef Feature : CPUFeatures) {
+            auto It = Testable.find(Feature);
+            if (It != Testable.end())
+                AddTest(It->getValue());
+        }
+        if (!C.Mask)
+            throw std::runtime_error("codegen error: no way to tell at run time whether the CPU is a '" +
+                                     Target.str() + "'");
+        C.Suffix = "arch_" + Target.str();
+        C.CPU = Target.str();
+        return C;
+    }
+
+    auto It = Testable.find(Target);
+    if (It == Testable.end())
+        throw std::runtime_error("codegen error: '@clones' target '" + Target.str() +
+                                 "' is neither a feature the CPU can be tested for nor 'arch=<cpu>'");
+    AddTest(It->getValue());
+    C.Suffix = Target.str();
+    C.Features += (C.Features.empty() ? "+" : ",+") + Target.str();
+    return C;
+}
+
+llvm::GlobalIFunc *EmitTargetClones(llvm::Function &F, llvm::ArrayRef<std::string_view> Targets,
+                                    const llvm::TargetMachine &TM) {
+    const llvm::Triple &TT = TM.getTargetTriple();
+    if (TT.getArch() != llvm::Triple::x86_64 || !TT.isOSBinFormatELF())
+        throw std::runtime_error("codegen error: '@clones' needs an x86-64 ELF target");
+
+    llvm::SmallVector<Clone, 4> Clones;
+    llvm::StringSet<> Seen;
+    for (std::string_view Target : Targets) {
+        llvm::StringRef Name(Target.data(), Target.size());
+        if (!Seen.insert(Name).second)
+            throw std::runtime_error("codegen error: '@clones' target '" + Name.str() + "' given twice");
+        if (Name != "default")
+            Clones.push_back(DescribeClone(Name, TM));
+    }
+    // the resolver tests the most specific clones first
+    std::stable_sort(Clones.begin(), Clones.end(),
+                     [](const Clone &A, const Clone &B) { return A.Priority > B.Priority; });
+
+    llvm::Module &M = *F.getParent();
+    llvm::LLVMContext &Ctx = M.getContext();
+    std::string Name = F.getName().str();
+    F.setName(Name + ".default");
+    F.setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    auto *Resolver = llvm::Function::Create(llvm::FunctionType::get(F.getType(), false),
+                                            llvm::GlobalValue::InternalLinkage, Name + ".resolver", M);
+    llvm::GlobalIFunc *IFunc = llvm::GlobalIFunc::create(F.getFunctionType(), F.getAddressSpace(),
+                                                         llvm::GlobalValue::ExternalLinkage, Name, Resolver, &M);
+    F.replaceAllUsesWith(IFunc);
+
+    llvm::IRBuilder<> B(llvm::BasicBlock::Create(Ctx, "entry", Resolver));
+    // ifunc resolvers can run before any constructor, __cpu_indicator_init's included
+    B.CreateCall(M.getOrInsertFunction("__cpu_indicator_init", B.getVoidTy()));
+    auto *ModelTy = llvm::StructType::get(B.getInt32Ty(), B.getInt32Ty(), B.getInt32Ty(),
+                                          llvm::ArrayType::get(B.getInt32Ty(), 1));
+    llvm::Value *Features1 = B.CreateLoad(
+            B.getInt32Ty(), B.CreateInBoundsGEP(ModelTy, M.getOrInsertGlobal("__cpu_model", ModelTy),
+                                                {B.getInt32(0), B.getInt32(3), B.getInt32(0)}));
+    llvm::Value *Features2 = B.CreateLoad(B.getInt32Ty(), M.getOrInsertGlobal("__cpu_features2", B.getInt32Ty()));
+
+    // built from the least specific clone up, so the first test that passes wins
+    llvm::Value *Chosen = &F;
+    for (const Clone &C : llvm::reverse(Clones)) {
+        llvm::ValueToValueMapTy VMap;
+        llvm::Function *Body = llvm::CloneFunction(&F, VMap);
+        Body->setName(Name + "." + C.Suffix);
+        Body->addFnAttr("target-cpu", C.CPU);
+        if (!C.Features.empty())
+            Body->addFnAttr("target-features", C.Features);
+
+        llvm::Value *Supported = B.getTrue();
+        for (auto [Bits, Word] : {std::make_pair(std::uint32_t(C.Mask), Features1),
+                                  std::make_pair(std::uint32_t(C.Mask >> 32), Features2)}) {
+            if (Bits)
+                Supported = B.CreateAnd(Supported, B.CreateICmpEQ(B.CreateAnd(Word, Bits), B.getInt32(Bits)));
+        }
+        Chosen = B.CreateSelect(Supported, Body, Chosen);
+    }
+    B.CreateRet(Chosen);
+    return IFunc;
+}
@@ -0,0 +1,103 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Compiler/ThinLTOLink.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/LTO/LTO.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/Caching.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "Compiler/Target.hpp"
+
+void ThinLTOLink(llvm::ArrayRef<std::string> Inputs, llvm::ArrayRef<std::string> Outputs,
+                 const CompilerOptions &Options, unsigned Jobs) {
+    // registers the target the backends will need
+    std::string Error;
+    llvm::CodeGenOpt::Level CGOptLevel = GetCodeGenOptLevel(Options.OptLevel);
+    if (!GetCachedTarget(Options.TargetTriple, Options.CPU, Options.Features, CGOptLevel, Error))
+        throw std::runtime_error(Error);
+
+    llvm::lto::Config Conf;
+    // the same code SaveObjectToFile would generate for each module on its own
+    Conf.CPU = Options.CPU.empty() ? "generic" : Options.CPU;
+    Conf.MAttrs = llvm::SubtargetFeatures(Options.Features).getFeatures();
+    Conf.RelocModel = llvm::None;
+    Conf.OptLevel = Options.OptLevel.getSpeedupLevel();
+    Conf.CGOptLevel = CGOptLevel;
+    Conf.DefaultTriple = Options.TargetTriple.empty() ? llvm::sys::getDefaultTargetTriple()
+                                                      : llvm::Triple::normalize(Options.TargetTriple);
+    Conf.TimeTraceEnabled = llvm::timeTraceProfilerEnabled();
+
+    llvm::lto::LTO Link(std::move(Conf),
+                        llvm::lto::createInProcessThinBackend(llvm::heavyweight_hardware_concurrency(Jobs)));
+
+    llvm::StringSet<> Visible;
+    Visible.insert("main");
+    for (const std::string &Name : Options.Exports)
+        Visible.insert(Name);
+
+    // the modules refer into their buffers until the link is done
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> Buffers;
+    llvm::StringSet<> Defined;
+    for (const std::string &InputPath : Inputs) {
+        auto BufferOrErr = llvm::MemoryBuffer::getFile(InputPath);
+        if (!BufferOrErr)
+            throw std::runtime_error(InputPath + ": " + BufferOrErr.getError().message());
+        Buffers.push_back(std::move(*BufferOrErr));
+
+        auto FileOrErr = llvm::lto::InputFile::create(Buffers.back()->getMemBufferRef());
+        if (!FileOrErr)
+            throw std::runtime_error(InputPath + ": " + llvm::toString(FileOrErr.takeError()));
+        std::unique_ptr<llvm::lto::InputFile> File = std::move(*FileOrErr);
+        // without a summary the module would go into a single regular LTO partition
+        auto Info = File->getSingleBitcodeModule().getLTOInfo();
+        if (!Info || !Info->IsThinLTO) {
+            llvm::consumeError(Info.takeError());
+            throw std::runtime_error(InputPath + ": not bitcode written with --emit=bc");
+        }
+
+        // what a linker would decide for each symbol: the first definition of a
+        // name is the one kept
+        std::vector<llvm::lto::SymbolResolution> Resolutions;
+        for (const llvm::lto::InputFile::Symbol &Sym : File->symbols()) {
+            llvm::lto::SymbolResolution R;
+            if (!Sym.isUndefined()) {
+                R.Prevailing = Defined.insert(Sym.getName()).second;
+                if (!R.Prevailing && !Sym.isWeak())
+                    throw std::runtime_error(InputPath + ": '" + Sym.getName().str() +
+                                             "' is already defined by another input");
+                R.FinalDefinitionInLinkageUnit = true;
+            }
+            R.VisibleToRegularObj = Visible.count(Sym.getName());
+            Resolutions.push_back(R);
+        }
+        if (llvm::Error Err = Link.add(std::move(File), Resolutions))
+            throw std::runtime_error(InputPath + ": " + llvm::toString(std::move(Err)));
+    }
+
+    // ThinLTO's tasks come after the regular LTO partitions (unused here), one
+    // per module in the order they were added
+    std::size_t FirstThinTask = Link.getMaxTasks() - Inputs.size();
+    auto AddStream = [&](unsigned Task) -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>> {
+        if (Task < FirstThinTask)
+            return llvm::createStringError(llvm::inconvertibleErrorCode(), "unexpected regular LTO output");
+        std::error_code EC;
+        auto OS = std::make_unique<llvm::raw_fd_ostream>(Outputs[Task - FirstThinTask], EC, llvm::sys::fs::OF_None);
+        if (EC)
+            return llvm::createFileError(Outputs[Task - FirstThinTask], EC);
+        return std::make_unique<llvm::CachedFileStream>(std::move(OS));
+    };
+    if (llvm::Error Err = Link.run(AddStream))
+        throw std::runtime_error("thinlto error: " + llvm::toString(std::move(Err)));
+}
@@ -8,14 +8,12 @@
 #include <stdexcept>
 #include "Token/Token.hpp"
 
-// static members
-char Lexer::LastChar = ' ';
-int Lexer::CharIdx = 0;
-position Lexer::Position;
-std::string Lexer::Source;
-
 Token Lexer::getTok() {
-    LastChar = Source[CharIdx];
+    // index through data() so that reading the terminating null at
+    // Source.length() stays well-defined
+    const char *Src = Source.data();
+
+    LastChar = Src[CharIdx];
 
     if (isspace(LastChar)) {
         while (isspace(LastChar)) {
@@ -31,23 +29,22 @@ Token Lexer::getTok() {
                 default:
                     break;
             }
-            LastChar = Source[++CharIdx];
+            LastChar = Src[++CharIdx];
         }
     }
 
     if (isalpha(LastChar)) {
         Token t(Token::type::tok_ident);
-        while (isalnum((LastChar = Source[CharIdx++]))) {
-            t.value += LastChar;
-        }
+        int Start = CharIdx;
+        while (isalnum((LastChar = Src[CharIdx++])));
 
         CharIdx--; // go back one since one was added after the while loop
+        t.value = Source.substr(Start, CharIdx - Start);
 
         // deal with keywords
-        if (t.value == "func") t.type = Token::type::tok_func;
-        if (t.value == "extern") t.type = Token::type::tok_extern;
-        if (t.value == "return") t.type = Token::type::tok_return;
-        if (t.value == "var") t.type = Token::type::tok_var;
+        t.type = Token::GetKeywordType(t.value);
+        if (t.type == Token::type::tok_ident)
+            t.sym = Names.intern(t.value);
 
         t.pos = Position;
         Position.column += (int)t.value.length();
@@ -59,7 +56,8 @@ Token Lexer::getTok() {
 
         Token t(Token::type::tok_number);
         t.pos = Position;
-        while (isdigit((LastChar = Source[CharIdx++])) || LastChar /* already set by prev cond */ == '.') {
+        int Start = CharIdx;
+        while (isdigit((LastChar = Src[CharIdx++])) || LastChar /* already set by prev cond */ == '.') {
             if (foundPoint) {
                 if (LastChar == '.') { // multiple decimal points
                     // TODO: implement error interface
@@ -68,11 +66,10 @@ Token Lexer::getTok() {
             } else {
                 foundPoint = (LastChar == '.');
             }
-
-            t.value += LastChar;
         }
 
         CharIdx--; // go back one since one was added after the while loop
+        t.value = Source.substr(Start, CharIdx - Start);
 
         Position.column += (int)t.value.length();
         return t;
@@ -83,99 +80,119 @@ Token Lexer::getTok() {
         t.pos = Position;
 
         Position.column++; // preemptively increment for first quotation mark
-        while((LastChar = Source[++CharIdx]) != '"' /* second mark */) { // move past first quotation mark
+        int Start = CharIdx + 1;
+        // only allocated once the first escape sequence shows up
+        std::string *Decoded = nullptr;
+        while((LastChar = Src[++CharIdx]) != '"' /* second mark */) { // move past first quotation mark
             if (LastChar == '\n' || CharIdx == Source.length())
                 throw std::runtime_error("lexer error: unterminated string");
             // TODO: handle escape codes: https://en.cppreference.com/w/cpp/language/escape
             if (LastChar == '\\') {
-                LastChar = Source[++CharIdx];
+                if (!Decoded)
+                    Decoded = &DecodedStrings.emplace_back(Source.substr(Start, CharIdx - Start));
+                LastChar = Src[++CharIdx];
                 Position.column++;
                 switch(LastChar) {
                     case '\'':
-                        t.value += '\x27';
+                        *Decoded += '\x27';
                         break;
                     case '"':
-                        t.value += '\x22';
+                        *Decoded += '\x22';
                         break;
                     case '?':
-                        t.value += '\x3f';
+                        *Decoded += '\x3f';
                         break;
                     case '\\':
-                        t.value += '\x5c';
+                        *Decoded += '\x5c';
                         break;
                     case 'a':
-                        t.value += '\x7';
+                        *Decoded += '\x7';
                         break;
                     case 'b':
-                        t.value += '\x8';
+                        *Decoded += '\x8';
                         break;
                     case 'f':
-                        t.value += '\xc';
+                        *Decoded += '\xc';
                         break;
                     case 'n':
-                        t.value += '\x0a';
+                        *Decoded += '\x0a';
                         break;
                     case 'r':
-                        t.value += '\x0d';
+                        *Decoded += '\x0d';
                         break;
                     case 't':
-                        t.value += '\x09';
+                        *Decoded += '\x09';
                         break;
                     case 'v':
-                        t.value += '\x0b';
+                        *Decoded += '\x0b';
                         break;
                     // case 'x': // hexadecimal byte
                     //     std::string temp;
-                    //     while (isdigit(LastChar = Source[++CharIdx])) {
+                    //     while (isdigit(LastChar = Src[++CharIdx])) {
                     //         Position.column++;
                     //         temp += LastChar;
                     //         std::cout << temp << std::endl;
                     //     }
                     //     CharIdx--;
                     //     std::cout << '\n' << std::stoull(temp) << std::endl;
-                    //     t.value += std::stoull(temp);
+                    //     *Decoded += std::stoull(temp);
                 }
                 Position.column++;
             } else {
-                t.value += LastChar;
+                if (Decoded)
+                    *Decoded += LastChar;
                 Position.column++;
             }
         }
 
+        t.value = Decoded ? std::string_view(*Decoded) : Source.substr(Start, CharIdx - Start);
         CharIdx++; // eat terminating '"'
         Position.column++;
         return t;
     }
 
-    if (Token::BinOpPrecedence[{LastChar}]) { // check if first char is op
+    if (Token::IsOpChar(LastChar)) { // check if first char is op
         Token t(Token::type::tok_binop);
-        t.value = {LastChar};
         t.pos = Position;
+        int Start = CharIdx;
 
         CharIdx++; // move past first char
 
-        while (Token::BinOpPrecedence[{(LastChar = Source[CharIdx++])}]) {
-            t.value += LastChar;
-        }
+        while (Token::IsOpChar(LastChar = Src[CharIdx++]));
 
         CharIdx--; // go back one since one was added after the while loop
+        t.value = Source.substr(Start, CharIdx - Start);
 
         Position.column += (int)t.value.length();
         return t;
     }
 
     if (CharIdx == Source.length())
-        return Token{Token::type::tok_eof, std::string(), Position};
+        return Token{Token::type::tok_eof, std::string_view(), Position};
 
-    Token otherTok = Token{Token::type::tok_other, std::string({Source[CharIdx]}), Position};
+    Token otherTok = Token{Token::type::tok_other, Source.substr(CharIdx, 1), Position};
     CharIdx++;
     Position.column++;
     return otherTok;
 }
 
-Lexer::Lexer() = default;
-Lexer::Lexer(std::string source) {
-    Source = std::move(source);
-};
+void Lexer::Tokenize() {
+    Tokens.clear();
+    // rough guess at the token density so big inputs don't regrow from scratch
+    Tokens.reserve(Source.length() / 8 + 1);
+    do {
+        Tokens.push_back(getTok());
+    } while (Tokens.back().type != Token::type::tok_eof);
+}
+
+void Lexer::reset(std::string_view source) {
+    Source = source;
+    LastChar = ' ';
+    CharIdx = 0;
+    Position = {};
+    Tokens.clear();
+}
+
+Lexer::Lexer(std::string_view source, StringInterner &Names) : Source(source), Names(Names) {}
 
 Lexer::~Lexer() = default;
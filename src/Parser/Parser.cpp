@@ -6,69 +6,72 @@
 #include <string>
 
 #include "Parser/Parser.hpp"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Program.h"
 
-Token Parser::CurrentToken;
+Parser::Parser(const std::vector<Token> &Tokens, ASTContext &AST) : Tokens(Tokens), AST(AST) {}
 
-std::unique_ptr<ExprAST> Parser::ParseNumberExpr() {
-    auto ret = std::make_unique<NumberExprAST>(CurrentToken.value);
-    getNextToken(); // eat literal
+ExprAST *Parser::ParseNumberExpr() {
+    auto ret = at(peek().pos, AST.create<NumberExprAST>(peek().value));
+    advance(); // eat literal
     return ret;
 }
 
-std::unique_ptr<ExprAST> Parser::ParseStringExpr() {
-    auto ret = std::make_unique<StringExprAST>(CurrentToken.value);
-    getNextToken(); // eat literal
+ExprAST *Parser::ParseStringExpr() {
+    auto ret = at(peek().pos, AST.create<StringExprAST>(peek().value));
+    advance(); // eat literal
     return ret;
 }
 
-std::unique_ptr<ExprAST> Parser::ParseParenExpr() {
-    getNextToken(); // eat (
+ExprAST *Parser::ParseParenExpr() {
+    advance(); // eat (
     auto V = ParseExpression();
     if (!V)
         return nullptr;
 
-    if (CurrentToken.value != ")")
+    if (peek().value != ")")
         throw std::runtime_error("parser error: expected ')'");
-    getNextToken(); // eat )
+    advance(); // eat )
     return V;
 }
 
-std::unique_ptr<ExprAST> Parser::ParseIdentifierExpr() {
-    std::string IdName = CurrentToken.value;
-    getNextToken(); // eat ident
+ExprAST *Parser::ParseIdentifierExpr() {
+    Symbol IdName = peek().sym;
+    position Start = peek().pos;
+    advance(); // eat ident
 
-    if (CurrentToken.value != "(") // if it's just a variable and not a call
-        return std::make_unique<VariableExprAST>(IdName);
+    if (peek().value != "(") // if it's just a variable and not a call
+        return at(Start, AST.create<VariableExprAST>(IdName));
 
     // function call
-    getNextToken(); // eat (
-    std::vector<std::unique_ptr<ExprAST>> Args;
-    // todo: maybe `while CurrentToken.value != ")"...`
-    if (CurrentToken.value != ")") {
+    advance(); // eat (
+    llvm::SmallVector<ExprAST *, 8> Args;
+    // todo: maybe `while peek().value != ")"...`
+    if (peek().value != ")") {
         while (true) {
             if (auto Arg = ParseExpression())
-                Args.push_back(std::move(Arg));
+                Args.push_back(Arg);
             else
                 return nullptr;
 
-            if (CurrentToken.value == ")")
+            if (peek().value == ")")
                 break;
 
-            if (CurrentToken.value != ",")
+            if (peek().value != ",")
                 throw std::runtime_error("parser error: expected only ')', ',', or expression in arg list");
 
-            getNextToken();
+            advance();
         }
     }
 
-    getNextToken(); // eat ')'
+    advance(); // eat ')'
 
-    return std::make_unique<CallExprAST>(IdName, std::move(Args));
+    return at(Start, AST.create<CallExprAST>(IdName, AST.copyArray<ExprAST *>(Args)));
 }
 
-std::unique_ptr<ExprAST> Parser::ParsePrimary() {
-    switch  (CurrentToken.type) {
+ExprAST *Parser::ParsePrimary() {
+    switch  (peek().type) {
         case Token::type::tok_ident:
             return ParseIdentifierExpr();
         case Token::type::tok_number:
@@ -76,29 +79,30 @@ std::unique_ptr<ExprAST> Parser::ParsePrimary() {
         case Token::type::tok_string:
             return ParseStringExpr();
         case Token::type::tok_other:
-            if (CurrentToken.value == "(")
+            if (peek().value == "(")
                 return ParseParenExpr();
         default:
-            throw std::runtime_error("unknown token '" + CurrentToken.value + "'");
+            throw std::runtime_error("unknown token '" + std::string(peek().value) + "'");
     }
 }
 
-std::unique_ptr<ExprAST> Parser::ParseExpression() {
+ExprAST *Parser::ParseExpression() {
     auto Left = ParsePrimary();
     if (!Left) return nullptr;
 
-    return ParseBinOpRight(std::numeric_limits<int>::max() - 1, std::move(Left));
+    return ParseBinOpRight(std::numeric_limits<int>::max() - 1, Left);
 }
 
-std::unique_ptr<ExprAST> Parser::ParseBinOpRight(int ExprPrecedence, std::unique_ptr<ExprAST> Left) {
+ExprAST *Parser::ParseBinOpRight(int ExprPrecedence, ExprAST *Left) {
     while (true) {
-        int TokenPrecedence = CurrentToken.GetPrecedence();
+        int TokenPrecedence = peek().GetPrecedence();
 
         if (TokenPrecedence > ExprPrecedence)
             return Left;
 
-        Token BinaryOp = CurrentToken;
-        getNextToken(); // eat binop
+        BinaryOp Op = Token::GetBinaryOp(peek().value);
+        position OpLoc = peek().pos;
+        advance(); // eat binop
 
         // parse the primary expr after the operator
         auto Right = ParsePrimary();
@@ -106,181 +110,326 @@ std::unique_ptr<ExprAST> Parser::ParseBinOpRight(int ExprPrecedence, std::unique
             return nullptr;
 
         // determine association
-        int NextPrecedence = CurrentToken.GetPrecedence();
+        int NextPrecedence = peek().GetPrecedence();
         if (TokenPrecedence > NextPrecedence) {
-            Right = ParseBinOpRight(TokenPrecedence - 1, std::move(Right));
+            Right = ParseBinOpRight(TokenPrecedence - 1, Right);
             if (!Right)
                 return nullptr;
         }
         // merge both sides
-        Left = std::make_unique<BinaryExprAST>(BinaryOp, std::move(Left), std::move(Right));
+        Left = at(OpLoc, AST.create<BinaryExprAST>(Op, Left, Right));
     }
 }
 
-std::unique_ptr<PrototypeAST> Parser::ParsePrototype() {
+PrototypeAST *Parser::ParsePrototype() {
     bool IsVarArg = false;
 
-    if (CurrentToken.type != Token::type::tok_ident)
+    if (peek().type != Token::type::tok_ident)
         throw std::runtime_error("parser error: expected function name in prototype");
 
-    std::string Name = CurrentToken.value;
-    getNextToken(); // eat name
+    Symbol Name = peek().sym;
+    position Start = peek().pos;
+    advance(); // eat name
 
-    if (CurrentToken.value != "(")
+    if (peek().value != "(")
         throw std::runtime_error("parser error: expected '(' in prototype");
 
-    getNextToken(); // eat '('
+    advance(); // eat '('
     // read args
-    std::vector<std::pair<std::string /* name */, Type /* type */>> Args;
-    if (CurrentToken.value != ")") {
+    llvm::SmallVector<std::pair<Symbol /* name */, Type /* type */>, 8> Args;
+    if (peek().value != ")") {
         while (true) { // loop through each arg
-            std::string ArgName;
-            std::string ArgTypeName;
+            Symbol ArgName;
+            std::string_view ArgTypeName;
             bool ArgTypePointer = false;
 
             // todo: instead of using other for ellipsis create custom token
-            if (CurrentToken.type == Token::type::tok_ident || CurrentToken.type == Token::type::tok_other) {
-                if (CurrentToken.value == ".") {
-                    getNextToken(); // eat first point in ellipsis
-                    if (CurrentToken.value == ".") {
-                        getNextToken(); // second
-                        if (CurrentToken.value == ".") {
+            if (peek().type == Token::type::tok_ident || peek().type == Token::type::tok_other) {
+                if (peek().value == ".") {
+                    advance(); // eat first point in ellipsis
+                    if (peek().value == ".") {
+                        advance(); // second
+                        if (peek().value == ".") {
                             IsVarArg = true;
-                            getNextToken();
-                            if (CurrentToken.value != ")") {
+                            advance();
+                            if (peek().value != ")") {
                                 throw std::runtime_error("parser error: expected closing parenthesis after ellipsis");
                             }
                             break;
                         }
                     }
                 } 
-                ArgName = CurrentToken.value;
+                ArgName = peek().sym;
             } else
                 return nullptr;
 
-            getNextToken(); // eat arg name
+            advance(); // eat arg name
 
-            if (CurrentToken.value != ":")
+            if (peek().value != ":")
                 throw std::runtime_error("parser error: expected ':' between arg name and type");
-            getNextToken(); // eat ':'
+            advance(); // eat ':'
 
-            if (CurrentToken.type == Token::type::tok_ident)
-                ArgTypeName = CurrentToken.value;
+            if (peek().type == Token::type::tok_ident)
+                ArgTypeName = peek().value;
             else
                 return nullptr;
 
-            if (getNextToken().value == "*") { // eat type and check for pointer
+            if (advance().value == "*") { // eat type and check for pointer
                 ArgTypePointer = true;
-                getNextToken(); // eat '*'
+                advance(); // eat '*'
             }
 
-            Args.emplace_back(ArgName, Type(ArgTypeName, ArgTypePointer));
+            Args.emplace_back(ArgName, AST.getTypes().get(ArgTypeName, ArgTypePointer));
 
-            if (CurrentToken.value == ")")
+            if (peek().value == ")")
                 break;
 
-            if (CurrentToken.value != ",")
+            if (peek().value != ",")
                 throw std::runtime_error("parser error: expected only ')', ',', or expression in arg list");
 
-            getNextToken();
+            advance();
         }
     }
 
-    getNextToken(); // eat ')'
+    advance(); // eat ')'
 
-    if (CurrentToken.value != ":")
+    if (peek().value != ":")
         throw std::runtime_error("parser error: expected ':' before return type");
-    getNextToken(); // eat ':'
-    std::string RetTypeName = CurrentToken.value;
+    advance(); // eat ':'
+    std::string_view RetTypeName = peek().value;
     bool RetTypePointer = false;
-    if (getNextToken().value == "*") { // eat type and check for pointer
+    if (advance().value == "*") { // eat type and check for pointer
         RetTypePointer = true;
-        getNextToken(); // eat '*'
+        advance(); // eat '*'
     }
 
-    return std::make_unique<PrototypeAST>(Name, std::move(Args), Type(RetTypeName, RetTypePointer), IsVarArg);
+    return at(Start, AST.create<PrototypeAST>(Name, AST.copyArray<std::pair<Symbol, Type>>(Args),
+                                              AST.getTypes().get(RetTypeName, RetTypePointer), IsVarArg));
 }
 
-std::unique_ptr<FunctionAST> Parser::ParseFuncDefinition() {
-    getNextToken(); // eat func keyword
+FunctionAST *Parser::ParseFuncDefinition() {
+    // @clones("avx2", "arch=x86-64-v4", ...)
+    llvm::SmallVector<std::string_view, 4> Clones;
+    if (peek().value == "@") {
+        if (advance().value != "clones") // eat '@'
+            throw std::runtime_error("parser error: unknown function attribute '" + std::string(peek().value) + "'");
+        if (advance().value != "(") // eat name
+            throw std::runtime_error("parser error: expected '(' after '@clones'");
+        do {
+            const Token &Target = advance(); // eat '(' or ','
+            if (Target.type != Token::type::tok_string)
+                throw std::runtime_error("parser error: '@clones' takes a list of target strings");
+            Clones.push_back(Target.value);
+        } while (advance().value == ","); // eat target
+        if (peek().value != ")")
+            throw std::runtime_error("parser error: expected ')' after the targets of '@clones'");
+        if (advance().type != Token::type::tok_func) // eat ')'
+            throw std::runtime_error("parser error: '@clones' has to come right before 'func'");
+    }
+
+    advance(); // eat func keyword
     auto Proto = ParsePrototype();
     if (!Proto) return nullptr;
 
     // TODO: add block expression
     if (auto E = ParseStatement())
-        return std::make_unique<FunctionAST>(std::move(Proto), std::move(E));
+        return AST.create<FunctionAST>(Proto, E, AST.copyArray<std::string_view>(Clones));
     return nullptr;
 }
 
-std::unique_ptr<PrototypeAST> Parser::ParseExtern() {
-    getNextToken(); // eat extern
+PrototypeAST *Parser::ParseExtern() {
+    advance(); // eat extern
     return ParsePrototype();
 }
 
-std::unique_ptr<StatementAST> Parser::ParseStatement() {
-    switch (CurrentToken.type) {
+StatementAST *Parser::ParseStatement() {
+    switch (peek().type) {
         case Token::type::tok_return:
             return ParseReturnStatement();
         case Token::type::tok_var:
             return ParseVarDeclStatement();
+        case Token::type::tok_while:
+        case Token::type::tok_for:
+            return ParseLoopStatement();
         default:
-            if (CurrentToken.value == "{") {
+            if (peek().value == "@")
+                return ParseLoopStatement();
+            if (peek().value == "{") {
                 return ParseBlockStatement();
             }
+            if (peek().type == Token::type::tok_ident && peek(1).value == "=")
+                return ParseAssignStatement();
             return ParseExprStatement();
     }
 }
 
-std::unique_ptr<StatementAST> Parser::ParseExprStatement() {
+StatementAST *Parser::ParseExprStatement() {
     if (auto E = ParseExpression()) {
-        if (CurrentToken.value != ";") {
+        if (peek().value != ";") {
             throw std::runtime_error("parser error: missing semicolon at the end of statement");
         }
-        getNextToken(); // eat ';'
-        return std::make_unique<ExprStatementAST>(std::move(E));
+        advance(); // eat ';'
+        return at(E->getLoc(), AST.create<ExprStatementAST>(E));
     }
     return nullptr;
 }
 
-std::unique_ptr<StatementAST> Parser::ParseBlockStatement() {
-    getNextToken(); // eat {
-    std::vector<std::unique_ptr<StatementAST>> Statements;
-    while (CurrentToken.value != "}") {
+StatementAST *Parser::ParseBlockStatement() {
+    position Start = peek().pos;
+    advance(); // eat {
+    llvm::SmallVector<StatementAST *, 16> Statements;
+    while (peek().value != "}") {
         if (auto V = ParseStatement())
-            Statements.push_back(std::move(V));
+            Statements.push_back(V);
         else
             return nullptr;
     }
 
-    getNextToken(); // eat }
-    return std::make_unique<BlockStatementAST>(std::move(Statements));
+    advance(); // eat }
+    return at(Start, AST.create<BlockStatementAST>(AST.copyArray<StatementAST *>(Statements)));
 }
 
-std::unique_ptr<StatementAST> Parser::ParseReturnStatement() {
-    getNextToken(); // eat "return"
+StatementAST *Parser::ParseReturnStatement() {
+    position Start = peek().pos;
+    advance(); // eat "return"
 
     if (auto Arg = ParseExpression()) {
-        if (CurrentToken.value != ";") {
+        if (peek().value != ";") {
             throw std::runtime_error("parser error: missing semicolon at the end of return statement");
         }
-        getNextToken(); // eat ';'
-        return std::make_unique<ReturnStatementAST>(std::move(Arg));
+        advance(); // eat ';'
+        return at(Start, AST.create<ReturnStatementAST>(Arg));
     }
 
     return nullptr;
 }
 
-std::unique_ptr<StatementAST> Parser::ParseVarDeclStatement() {
-    getNextToken(); // eat "var"
+StatementAST *Parser::ParseVarDeclStatement() {
+    position Start = peek().pos;
+    advance(); // eat "var"
+
+    if (peek().type != Token::type::tok_ident)
+        throw std::runtime_error("parser error: expected variable name after 'var'");
+    Symbol Name = peek().sym;
+
+    if (advance().value != ":") // eat name
+        throw std::runtime_error("parser error: expected ':' separating var name and type");
+    std::string_view TypeName = advance().value; // eat ':' and get type
+    bool TypePointer = false;
+    if (advance().value == "*") { // eat type and check for pointer
+        TypePointer = true;
+        advance(); // eat '*'
+    }
+
+    ExprAST *Init = nullptr;
+    if (peek().value == "=") {
+        advance(); // eat '='
+        if (!(Init = ParseExpression()))
+            return nullptr;
+    }
+
+    if (peek().value != ";")
+        throw std::runtime_error("parser error: missing semicolon at the end of var declaration");
+    advance(); // eat ';'
+    return at(Start, AST.create<VarDeclStatementAST>(Name, AST.getTypes().get(TypeName, TypePointer), Init));
+}
 
-    if (auto Var = ParseExpression()) {
-        if (CurrentToken.value != ":") {
-            throw std::runtime_error("parser error: expected ':' separating var name and type");
+StatementAST *Parser::ParseAssignStatement(bool ExpectSemicolon) {
+    Symbol Name = peek().sym;
+    position Start = peek().pos;
+    advance(); // eat name
+    if (peek().value != "=")
+        throw std::runtime_error("parser error: expected '=' after variable name");
+    advance(); // eat '='
+
+    if (auto Value = ParseExpression()) {
+        if (ExpectSemicolon) {
+            if (peek().value != ";")
+                throw std::runtime_error("parser error: missing semicolon at the end of assignment");
+            advance(); // eat ';'
         }
-        std::string Type = getNextToken().value; // eat ':' and get type
-        getNextToken(); // eat type
-        return std::make_unique<VarDeclStatementAST>(std::move(Var), std::move(Type));
+        return at(Start, AST.create<AssignStatementAST>(Name, Value));
+    }
+
+    return nullptr;
+}
+
+LoopHints Parser::ParseLoopHints() {
+    LoopHints Hints;
+    while (peek().value == "@") {
+        std::string_view Name = advance().value; // eat '@'
+        unsigned *Hint = Name == "vectorize" ? &Hints.VectorizeWidth : Name == "unroll" ? &Hints.UnrollCount : nullptr;
+        if (!Hint)
+            throw std::runtime_error("parser error: unknown loop hint '" + std::string(Name) + "'");
+        if (advance().value != "(") // eat name
+            throw std::runtime_error("parser error: expected '(' after loop hint");
+        const Token &Count = advance(); // eat '('
+        if (Count.type != Token::type::tok_number || !llvm::to_integer(Count.value, *Hint, 10) || *Hint == 0)
+            throw std::runtime_error("parser error: loop hint '" + std::string(Name) + "' takes a positive integer");
+        if (advance().value != ")") // eat count
+            throw std::runtime_error("parser error: expected ')' after loop hint");
+        advance(); // eat ')'
+    }
+    return Hints;
+}
+
+StatementAST *Parser::ParseLoopStatement() {
+    LoopHints Hints = ParseLoopHints();
+    bool IsWhile = peek().type == Token::type::tok_while;
+    if (!IsWhile && peek().type != Token::type::tok_for)
+        throw std::runtime_error("parser error: loop hints have to come right before 'while' or 'for'");
+    position Start = peek().pos;
+
+    if (advance().value != "(") // eat keyword
+        throw std::runtime_error("parser error: expected '(' after loop keyword");
+    advance(); // eat '('
+
+    if (IsWhile) {
+        auto Cond = ParseExpression();
+        if (!Cond)
+            return nullptr;
+        if (peek().value != ")")
+            throw std::runtime_error("parser error: expected ')' after while condition");
+        advance(); // eat ')'
+        if (auto Body = ParseStatement())
+            return at(Start, AST.create<WhileStatementAST>(Cond, Body, Hints));
+        return nullptr;
+    }
+
+    // for (init; cond; step): each part may be left out
+    StatementAST *Init = nullptr;
+    if (peek().value == ";") {
+        advance(); // eat ';'
+    } else {
+        if (peek().type == Token::type::tok_var)
+            Init = ParseVarDeclStatement();
+        else if (peek().type == Token::type::tok_ident)
+            Init = ParseAssignStatement();
+        else
+            throw std::runtime_error("parser error: expected var declaration or assignment to start a for loop");
+        if (!Init)
+            return nullptr;
+    }
+
+    ExprAST *Cond = nullptr;
+    if (peek().value != ";" && !(Cond = ParseExpression()))
+        return nullptr;
+    if (peek().value != ";")
+        throw std::runtime_error("parser error: expected ';' after for loop condition");
+    advance(); // eat ';'
+
+    StatementAST *Step = nullptr;
+    if (peek().value != ")") {
+        if (peek().type != Token::type::tok_ident)
+            throw std::runtime_error("parser error: expected assignment as the step of a for loop");
+        if (!(Step = ParseAssignStatement(false)))
+            return nullptr;
     }
+    if (peek().value != ")")
+        throw std::runtime_error("parser error: expected ')' after for loop step");
+    advance(); // eat ')'
 
+    if (auto Body = ParseStatement())
+        return at(Start, AST.create<ForStatementAST>(Init, Cond, Step, Body, Hints));
     return nullptr;
 }
@@ -0,0 +1,511 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Sema/Sema.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/ScopeExit.h"
+
+namespace {
+
+std::string Quote(const Type &T) {
+    return "'" + std::string(T.getSpelling()) + "'";
+}
+
+// the value of an integer literal; literals are never negative (there is no unary minus)
+std::uint64_t GetIntegerValue(const NumberExprAST *N) {
+    std::uint64_t Value;
+    llvm::StringRef Text(N->getValue().data(), N->getValue().size());
+    if (Text.getAsInteger(10, Value))
+        throw std::runtime_error("semantic error: integer literal " + Text.str() + " is too large");
+    return Value;
+}
+
+// the default type two untyped expressions share
+Type GetCommonType(const Type &A, const Type &B) {
+    // default types are only ever f8 when floating point
+    if (A.isFloatingPoint())
+        return A;
+    if (B.isFloatingPoint())
+        return B;
+    return A.getBitWidth() > B.getBitWidth() ? A : B;
+}
+
+bool HaveSameSignature(const PrototypeAST &A, const PrototypeAST &B) {
+    if (A.getReturnType() != B.getReturnType() || A.isVarArg() != B.isVarArg() ||
+        A.getArgs().size() != B.getArgs().size())
+        return false;
+    for (std::size_t i = 0; i < A.getArgs().size(); i++) {
+        if (A.getArgs()[i].second != B.getArgs()[i].second)
+            return false;
+    }
+    return true;
+}
+
+// whether a function body always gets to a return statement
+bool Returns(const StatementAST *Body) {
+    if (Body->getKind() == StatementAST::Kind::Return)
+        return true;
+    if (Body->getKind() != StatementAST::Kind::Block)
+        return false;
+    // codegen stops at the first return of a block, and only looks at the block itself
+    return llvm::any_of(static_cast<const BlockStatementAST *>(Body)->getStatements(),
+                        [](const StatementAST *S) { return S->getKind() == StatementAST::Kind::Return; });
+}
+} // namespace
+
+Sema::Sema(ASTContext &AST, StringInterner &Names, SymbolTable<PrototypeAST *> &Prototypes)
+        : AST(AST), Names(Names), Prototypes(Prototypes), S1(AST.getTypes().getInteger(8)),
+          S4(AST.getTypes().getInteger(32)), S8(AST.getTypes().getInteger(64)),
+          F4(AST.getTypes().getFloatingPoint(32)), F8(AST.getTypes().getFloatingPoint(64)),
+          String(AST.getTypes().getPointer(S1)), Void(AST.getTypes().getVoid()) {}
+
+void Sema::checkPrototype(const PrototypeAST *Proto) {
+    llvm::StringRef Name = Names.getName(Proto->getName());
+    for (const auto &Arg : Proto->getArgs()) {
+        if (!Arg.second.isValid() || Arg.second.isVoid())
+            throw std::runtime_error("semantic error: argument '" + Names.getName(Arg.first).str() + "' of '" +
+                                     Name.str() + "' can't have type " + Quote(Arg.second));
+    }
+    if (!Proto->getReturnType().isValid())
+        throw std::runtime_error("semantic error: '" + Name.str() + "' can't return type " +
+                                 Quote(Proto->getReturnType()));
+
+    // calls are checked against the latest declaration, so they all have to agree
+    const PrototypeAST *Earlier = Prototypes.lookup(Proto->getName());
+    if (Earlier && Earlier != Proto && !HaveSameSignature(*Earlier, *Proto))
+        throw std::runtime_error("semantic error: conflicting declarations of '" + Name.str() + "'");
+}
+
+void Sema::checkDefinition(FunctionAST *Definition) {
+    CurrentFunction = Definition->getProto();
+    resetDepths();
+    Variables.pushScope();
+    // the REPL carries on after an error, with the same instance
+    auto Restore = llvm::make_scope_exit([this] {
+        Variables.popScope();
+        CurrentFunction = nullptr;
+    });
+    for (const auto &Arg : CurrentFunction->getArgs())
+        Variables.insert(Arg.first, &Arg.second);
+
+    checkStatement(Definition->getBody());
+
+    const Type &ReturnType = CurrentFunction->getReturnType();
+    if (!ReturnType.isVoid() && !Returns(Definition->getBody()))
+        throw std::runtime_error("semantic error: '" + Names.getName(CurrentFunction->getName()).str() +
+                                 "' has to return a value of type " + Quote(ReturnType));
+}
+
+void Sema::checkTopLevelStatement(StatementAST *Statement) {
+    // a top-level statement runs in a wrapper of its own, so nothing could use the variable
+    if (Statement->getKind() == StatementAST::Kind::VarDecl) {
+        Symbol Name = static_cast<VarDeclStatementAST *>(Statement)->getName();
+        throw std::runtime_error("semantic error: '" + Names.getName(Name).str() + "' has to be declared in a function");
+    }
+    resetDepths();
+    checkStatement(Statement);
+}
+
+void Sema::resetDepths() {
+    // the guards below undo these on the way out of an error too, but GCC 12
+    // at -O2 drops the stores from the cleanup, which left the REPL rejecting
+    // every return after a failed entry
+    LoopDepth = 0;
+    BlockDepth = 0;
+}
+
+void Sema::checkStatement(StatementAST *S) {
+    switch (S->getKind()) {
+        case StatementAST::Kind::Expr:
+            infer(static_cast<ExprStatementAST *>(S)->Expr);
+            break;
+        case StatementAST::Kind::Block: {
+            Variables.pushScope();
+            ++BlockDepth;
+            auto Restore = llvm::make_scope_exit([this] {
+                --BlockDepth;
+                Variables.popScope();
+            });
+            for (StatementAST *Child : static_cast<BlockStatementAST *>(S)->getStatements())
+                checkStatement(Child);
+            break;
+        }
+        case StatementAST::Kind::Return: {
+            auto *Return = static_cast<ReturnStatementAST *>(S);
+            // a function's value is still whatever its body returns at the end
+            if (LoopDepth)
+                throw std::runtime_error("semantic error: can't return from inside a loop");
+            // codegen ends the function's body (or a top-level block) at its
+            // return, so one further in wouldn't end the function
+            if (BlockDepth > 1)
+                throw std::runtime_error("semantic error: can't return from inside a nested block");
+            // a top-level statement's wrapper returns whatever type it has
+            if (!CurrentFunction) {
+                infer(Return->Argument);
+                break;
+            }
+            llvm::StringRef Name = Names.getName(CurrentFunction->getName());
+            if (CurrentFunction->getReturnType().isVoid())
+                throw std::runtime_error("semantic error: '" + Name.str() + "' returns void, not a value");
+            convert(Return->Argument, CurrentFunction->getReturnType(), "the return value of '" + Name + "'");
+            break;
+        }
+        case StatementAST::Kind::VarDecl: {
+            auto *Decl = static_cast<VarDeclStatementAST *>(S);
+            llvm::StringRef Name = Names.getName(Decl->Name);
+            if (!Decl->VarType.isValid() || Decl->VarType.isVoid())
+                throw std::runtime_error("semantic error: '" + Name.str() + "' can't have type " +
+                                         Quote(Decl->VarType));
+            // checked before the variable is in scope: the initializer can't refer to it
+            if (Decl->Init)
+                convert(Decl->Init, Decl->VarType, "the initial value of '" + Name + "'");
+            Variables.insert(Decl->Name, &Decl->VarType);
+            break;
+        }
+        case StatementAST::Kind::Assign: {
+            auto *Assign = static_cast<AssignStatementAST *>(S);
+            llvm::StringRef Name = Names.getName(Assign->Name);
+            const Type *T = Variables.lookup(Assign->Name);
+            if (!T)
+                throw std::runtime_error("semantic error: unknown variable '" + Name.str() + "'");
+            // arguments stay plain values instead of getting a stack slot that
+            // the optimizer would have to promote back again
+            if (CurrentFunction && llvm::any_of(CurrentFunction->getArgs(), [T](const auto &Arg) { return &Arg.second == T; }))
+                throw std::runtime_error("semantic error: can't assign to argument '" + Name.str() +
+                                         "'; copy it into a var first");
+            convert(Assign->Value, *T, "the value assigned to '" + Name + "'");
+            break;
+        }
+        case StatementAST::Kind::While: {
+            auto *While = static_cast<WhileStatementAST *>(S);
+            checkCondition(While->Cond);
+            ++LoopDepth;
+            auto Restore = llvm::make_scope_exit([this] { --LoopDepth; });
+            checkStatement(While->Body);
+            break;
+        }
+        case StatementAST::Kind::For: {
+            auto *For = static_cast<ForStatementAST *>(S);
+            // a variable declared by the init statement is the loop's
+            Variables.pushScope();
+            ++LoopDepth;
+            auto Restore = llvm::make_scope_exit([this] {
+                --LoopDepth;
+                Variables.popScope();
+            });
+            if (For->Init)
+                checkStatement(For->Init);
+            if (For->Cond)
+                checkCondition(For->Cond);
+            if (For->Step)
+                checkStatement(For->Step);
+            checkStatement(For->Body);
+            break;
+        }
+    }
+}
+
+void Sema::checkCondition(ExprAST *&Cond) {
+    Type T = infer(Cond);
+    if (!T.isInteger())
+        throw std::runtime_error("semantic error: a loop condition has to be an integer, not " + Quote(T));
+}
+
+Type Sema::infer(ExprAST *&E) {
+    if (isUntyped(E)) {
+        setLiteralType(E, getDefaultType(E));
+        return E->getType();
+    }
+
+    switch (E->getKind()) {
+        case ExprAST::Kind::String:
+            E->setType(String);
+            break;
+        case ExprAST::Kind::Variable: {
+            Symbol Name = static_cast<VariableExprAST *>(E)->getName();
+            const Type *T = Variables.lookup(Name);
+            if (!T)
+                throw std::runtime_error("semantic error: unknown variable '" + Names.getName(Name).str() + "'");
+            E->setType(*T);
+            break;
+        }
+        case ExprAST::Kind::Binary:
+            E->setType(inferBinary(static_cast<BinaryExprAST *>(E)));
+            break;
+        case ExprAST::Kind::Call: {
+            auto *C = static_cast<CallExprAST *>(E);
+            // a declared function shadows the builtin of the same name
+            std::optional<BuiltinExprAST::Builtin> Op;
+            if (!Prototypes.lookup(C->Callee) && (Op = BuiltinExprAST::lookup(Names.getName(C->Callee))))
+                E = checkBuiltin(C, *Op);
+            else
+                E->setType(inferCall(C));
+            break;
+        }
+        case ExprAST::Kind::Number:
+        case ExprAST::Kind::Cast:
+        case ExprAST::Kind::Builtin:
+            // typed when they were created
+            break;
+    }
+    return E->getType();
+}
+
+Type Sema::inferBinary(BinaryExprAST *B) {
+    // a literal on one side takes the type of the other side
+    Type Operands;
+    bool LeftUntyped = isUntyped(B->Left), RightUntyped = isUntyped(B->Right);
+    if (LeftUntyped && RightUntyped) {
+        // only a compare gets here: arithmetic on two literals is untyped as a whole
+        Operands = GetCommonType(getDefaultType(B->Left), getDefaultType(B->Right));
+        setLiteralType(B->Left, Operands);
+        setLiteralType(B->Right, Operands);
+    } else if (LeftUntyped) {
+        Operands = infer(B->Right);
+        convert(B->Left, Operands, "an operand");
+    } else if (RightUntyped) {
+        Operands = infer(B->Left);
+        convert(B->Right, Operands, "an operand");
+    } else {
+        Operands = infer(B->Left);
+        Type Right = infer(B->Right);
+        // a scalar next to a vector goes into every lane
+        if (Operands.isVector() && !Right.isVector()) {
+            convert(B->Right, Operands, "an operand");
+        } else if (Right.isVector() && !Operands.isVector()) {
+            convert(B->Left, Right, "an operand");
+            Operands = Right;
+        } else if (Operands != Right) {
+            throw std::runtime_error("semantic error: mismatched operand types " + Quote(Operands) + " and " +
+                                     Quote(Right));
+        }
+    }
+
+    // vectors take the operators their lanes do, lane by lane
+    Type Element = Operands.getElementType();
+    if (!Element.isNumeric())
+        throw std::runtime_error("semantic error: operands of type " + Quote(Operands) + " aren't numbers");
+    if (Element.isFloatingPoint() && !BinaryExprAST::hasFloatingPointForm(B->Op))
+        throw std::runtime_error("semantic error: operator only takes integers, not " + Quote(Operands));
+    if (!BinaryExprAST::isCompare(B->Op))
+        return Operands;
+    return Operands.isVector() ? AST.getTypes().getVector(S1, Operands.getLanes()) : S1;
+}
+
+Type Sema::inferCall(CallExprAST *C) {
+    llvm::StringRef Name = Names.getName(C->Callee);
+    const PrototypeAST *Proto = Prototypes.lookup(C->Callee);
+    if (!Proto)
+        throw std::runtime_error("semantic error: unknown function '" + Name.str() + "'");
+
+    llvm::ArrayRef<std::pair<Symbol, Type>> Params = Proto->getArgs();
+    if (C->Args.size() < Params.size() || (!Proto->isVarArg() && C->Args.size() > Params.size()))
+        throw std::runtime_error("semantic error: '" + Name.str() + "' takes " + std::to_string(Params.size()) +
+                                 (Proto->isVarArg() ? " or more" : "") + " arguments, not " +
+                                 std::to_string(C->Args.size()));
+
+    for (std::size_t i = 0; i < Params.size(); i++)
+        convert(C->Args[i], Params[i].second, "argument " + llvm::Twine(i + 1) + " of '" + Name + "'");
+
+    // the rest are promoted the way C callees (printf) expect them
+    for (std::size_t i = Params.size(); i < C->Args.size(); i++) {
+        Type T = infer(C->Args[i]);
+        if (T.isVoid())
+            throw std::runtime_error("semantic error: argument " + std::to_string(i + 1) + " of '" + Name.str() +
+                                     "' has no value");
+        if (T == F4)
+            convert(C->Args[i], F8, "");
+        else if (T.isInteger() && T.getBitWidth() < S4.getBitWidth())
+            convert(C->Args[i], S4, "");
+    }
+
+    return Proto->getReturnType();
+}
+
+ExprAST *Sema::checkBuiltin(CallExprAST *C, BuiltinExprAST::Builtin Op) {
+    using Builtin = BuiltinExprAST::Builtin;
+    std::string Name = Names.getName(C->Callee).str();
+    auto Argument = [&](std::size_t i) { return "argument " + std::to_string(i + 1) + " of '" + Name + "'"; };
+    auto ExpectArgs = [&](std::size_t Count) {
+        if (C->Args.size() != Count)
+            throw std::runtime_error("semantic error: '" + Name + "' takes " + std::to_string(Count) +
+                                     " arguments, not " + std::to_string(C->Args.size()));
+    };
+    auto ExpectVector = [&](std::size_t i) {
+        Type T = infer(C->Args[i]);
+        if (!T.isVector())
+            throw std::runtime_error("semantic error: " + Argument(i) + " has to be a vector, not " + Quote(T));
+        return T;
+    };
+    auto ExpectVectorPointer = [&](std::size_t i) {
+        Type T = infer(C->Args[i]);
+        if (!T.isPointer() || !T.getPointeeType().isVector())
+            throw std::runtime_error("semantic error: " + Argument(i) + " has to point to a vector, not " +
+                                     Quote(T));
+        return T;
+    };
+    // an integer literal below Limit, which the builtin needs to know while compiling
+    auto ExpectConstant = [&](std::size_t i, std::uint64_t Limit) {
+        auto *N = static_cast<const NumberExprAST *>(C->Args[i]);
+        std::uint64_t Value;
+        if (C->Args[i]->getKind() != ExprAST::Kind::Number || N->isFloatingPoint() ||
+            (Value = GetIntegerValue(N)) >= Limit)
+            throw std::runtime_error("semantic error: " + Argument(i) + " has to be an integer literal below " +
+                                     std::to_string(Limit));
+        return (unsigned)Value;
+    };
+    auto ExpectLanes = [&](std::size_t i, unsigned Lanes) {
+        if (Lanes < 2 || Lanes > Type::MaxLanes || (Lanes & (Lanes - 1)))
+            throw std::runtime_error("semantic error: " + Argument(i) + " makes a vector of " +
+                                     std::to_string(Lanes) + " lanes; it takes a power of two from 2 to " +
+                                     std::to_string(Type::MaxLanes));
+        return Lanes;
+    };
+
+    // only the arguments that are values get generated; the rest are constants
+    std::size_t Operands = C->Args.size();
+    llvm::SmallVector<int, 16> Mask;
+    Type Result;
+    switch (Op) {
+        case Builtin::Splat: {
+            ExpectArgs(2);
+            unsigned Lanes = ExpectLanes(1, ExpectConstant(1, Type::MaxLanes + 1));
+            Type Element = infer(C->Args[0]);
+            if (!Element.isNumeric())
+                throw std::runtime_error("semantic error: can't splat " + Quote(Element) + " across a vector");
+            Result = AST.getTypes().getVector(Element, Lanes);
+            Operands = 1;
+            break;
+        }
+        case Builtin::Extract:
+            ExpectArgs(2);
+            Result = ExpectVector(0).getElementType();
+            convert(C->Args[1], S4, Argument(1));
+            break;
+        case Builtin::Insert:
+            ExpectArgs(3);
+            Result = ExpectVector(0);
+            convert(C->Args[1], Result.getElementType(), Argument(1));
+            convert(C->Args[2], S4, Argument(2));
+            break;
+        case Builtin::Shuffle: {
+            if (C->Args.size() < 4)
+                throw std::runtime_error("semantic error: 'shuffle' takes two vectors and the lanes to pick");
+            Type Vector = ExpectVector(0);
+            convert(C->Args[1], Vector, Argument(1));
+            for (std::size_t i = 2; i < C->Args.size(); i++)
+                Mask.push_back(ExpectConstant(i, 2 * Vector.getLanes()));
+            Result = AST.getTypes().getVector(Vector.getElementType(), ExpectLanes(C->Args.size() - 1, Mask.size()));
+            Operands = 2;
+            break;
+        }
+        case Builtin::ReduceAdd:
+        case Builtin::ReduceMul:
+        case Builtin::ReduceMin:
+        case Builtin::ReduceMax:
+            ExpectArgs(1);
+            Result = ExpectVector(0).getElementType();
+            break;
+        case Builtin::Load:
+        case Builtin::LoadUnaligned:
+            ExpectArgs(2);
+            Result = ExpectVectorPointer(0).getPointeeType();
+            convert(C->Args[1], S8, Argument(1));
+            break;
+        case Builtin::Store:
+        case Builtin::StoreUnaligned:
+            ExpectArgs(3);
+            convert(C->Args[2], ExpectVectorPointer(0).getPointeeType(), Argument(2));
+            convert(C->Args[1], S8, Argument(1));
+            Result = Void;
+            break;
+    }
+
+    auto *Call = AST.create<BuiltinExprAST>(Op, AST.copyArray<ExprAST *>(C->Args.take_front(Operands)),
+                                            AST.copyArray<int>(Mask), Result);
+    Call->setLoc(C->getLoc());
+    return Call;
+}
+
+void Sema::convert(ExprAST *&E, const Type &To, const llvm::Twine &Where) {
+    // a scalar used as a vector goes into every lane, once it has the lane type
+    if (To.isVector() && isUntyped(E)) {
+        setLiteralType(E, To.getElementType());
+        E = AST.create<CastExprAST>(E, To);
+        return;
+    }
+    if (isUntyped(E)) {
+        setLiteralType(E, To);
+        return;
+    }
+
+    Type From = infer(E);
+    if (From == To)
+        return;
+    if (To.isVector() && From.isNumeric()) {
+        if (From != To.getElementType())
+            E = AST.create<CastExprAST>(E, To.getElementType());
+        E = AST.create<CastExprAST>(E, To);
+        return;
+    }
+    // vectors convert lane by lane, between the same number of lanes
+    bool SameLanes = From.isVector() && To.isVector() && From.getLanes() == To.getLanes();
+    if (!SameLanes && (!From.isNumeric() || !To.isNumeric()))
+        throw std::runtime_error("semantic error: can't use " + Quote(From) + " as " + Quote(To) + " for " +
+                                 Where.str());
+    E = AST.create<CastExprAST>(E, To);
+}
+
+bool Sema::isUntyped(const ExprAST *E) {
+    if (E->getKind() == ExprAST::Kind::Number)
+        return true;
+    if (E->getKind() != ExprAST::Kind::Binary)
+        return false;
+    auto *B = static_cast<const BinaryExprAST *>(E);
+    return !BinaryExprAST::isCompare(B->Op) && isUntyped(B->Left) && isUntyped(B->Right);
+}
+
+Type Sema::getDefaultType(const ExprAST *E) const {
+    if (E->getKind() == ExprAST::Kind::Number) {
+        auto *N = static_cast<const NumberExprAST *>(E);
+        if (N->isFloatingPoint())
+            return F8;
+        return GetIntegerValue(N) <= INT32_MAX ? S4 : S8;
+    }
+
+    auto *B = static_cast<const BinaryExprAST *>(E);
+    return GetCommonType(getDefaultType(B->Left), getDefaultType(B->Right));
+}
+
+void Sema::setLiteralType(ExprAST *E, const Type &T) const {
+    if (!T.isNumeric())
+        throw std::runtime_error("semantic error: a number can't be used as " + Quote(T));
+
+    if (E->getKind() == ExprAST::Kind::Number) {
+        auto *N = static_cast<NumberExprAST *>(E);
+        if (T.isInteger()) {
+            if (N->isFloatingPoint())
+                throw std::runtime_error("semantic error: " + std::string(N->getValue()) + " used as " + Quote(T));
+            // the bit pattern has to fit; 255 is a valid s1
+            if (T.getBitWidth() < 64 && GetIntegerValue(N) >> T.getBitWidth())
+                throw std::runtime_error("semantic error: " + std::string(N->getValue()) + " doesn't fit in " +
+                                         Quote(T));
+        }
+        N->setType(T);
+        return;
+    }
+
+    auto *B = static_cast<BinaryExprAST *>(E);
+    if (T.isFloatingPoint() && !BinaryExprAST::hasFloatingPointForm(B->Op))
+        throw std::runtime_error("semantic error: operator only takes integers, not " + Quote(T));
+    setLiteralType(B->Left, T);
+    setLiteralType(B->Right, T);
+    B->setType(T);
+}
@@ -0,0 +1,12 @@
+//
+// Created by abheekd on 10/17/2026.
+//
+
+#include "Symbol/Symbol.hpp"
+
+Symbol StringInterner::intern(std::string_view Name) {
+    auto Inserted = Map.try_emplace(llvm::StringRef(Name.data(), Name.size()), (Symbol)Names.size());
+    if (Inserted.second)
+        Names.push_back(Inserted.first->getKey());
+    return Inserted.first->getValue();
+}
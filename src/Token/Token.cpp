@@ -3,42 +3,25 @@
 //
 
 #include <limits>
-#include <string>
-#include <utility>
 
 #include "Token/Token.hpp"
 
-std::map<std::string, int> Token::BinOpPrecedence;
+// the tables are evaluated at compile time, so check them there too
+static_assert(Token::GetBinOpPrecedence("*") == 5 && Token::GetBinOpPrecedence("+") == 6);
+static_assert(Token::GetBinOpPrecedence("<<") == 7 && Token::GetBinOpPrecedence(">=") == 9);
+static_assert(!Token::GetBinOpPrecedence("=") && !Token::GetBinOpPrecedence("*-"));
+static_assert(Token::GetBinaryOp(">>") == BinaryOp::Shr && Token::GetBinaryOp("<=") == BinaryOp::Le);
+static_assert(Token::GetKeywordType("return") == Token::type::tok_return);
+static_assert(Token::GetKeywordType("returns") == Token::type::tok_ident);
 
 Token::Token() : type(type::tok_other) {}
 Token::Token(enum type type) : type(type) {}
-Token::Token(enum type type, std::string value, struct position position) :
-        type(type), value(std::move(value)), pos(position) {}
-
-void Token::InitBinOps() {
-    Token::BinOpPrecedence["*"] = 5;
-    Token::BinOpPrecedence["/"] = 5;
-    Token::BinOpPrecedence["%"] = 5;
-
-    Token::BinOpPrecedence["+"] = 6;
-    Token::BinOpPrecedence["-"] = 6;
-
-    Token::BinOpPrecedence["<<"] = 7;
-    Token::BinOpPrecedence[">>"] = 7;
-
-    Token::BinOpPrecedence["<"] = 9;
-    Token::BinOpPrecedence["<="] = 9;
-    Token::BinOpPrecedence[">"] = 9;
-    Token::BinOpPrecedence[">="] = 79;
-}
-
-int Token::GetPrecedence() {
-    for (const auto &C : value)
-        if (!isascii(C))
-            return std::numeric_limits<int>::max();
+Token::Token(enum type type, std::string_view value, struct position position) :
+        type(type), value(value), pos(position) {}
 
+int Token::GetPrecedence() const {
     // make sure it has been declared
-    int TokenPrecedence = BinOpPrecedence[value];
+    int TokenPrecedence = GetBinOpPrecedence(value);
     if (TokenPrecedence <= 0) return std::numeric_limits<int>::max();
     return TokenPrecedence;
 }
@@ -0,0 +1,25 @@
+# feeds INPUT to `COMPILER --repl` and compares what it prints with the .out
+# (prompts and results) and .err (diagnostics) files next to it
+#
+# usage: cmake -DCOMPILER=<path> -DINPUT=<entries.ad> -P RunREPL.cmake
+
+get_filename_component(Dir "${INPUT}" DIRECTORY)
+get_filename_component(Name "${INPUT}" NAME_WE)
+
+execute_process(COMMAND "${COMPILER}" --repl
+        INPUT_FILE "${INPUT}"
+        OUTPUT_VARIABLE Out
+        ERROR_VARIABLE Err
+        RESULT_VARIABLE Result)
+if (NOT Result EQUAL 0)
+    message(FATAL_ERROR "--repl exited with ${Result}:\n${Err}")
+endif()
+
+file(READ "${Dir}/${Name}.out" ExpectedOut)
+file(READ "${Dir}/${Name}.err" ExpectedErr)
+if (NOT Out STREQUAL ExpectedOut)
+    message(FATAL_ERROR "output differs, expected:\n${ExpectedOut}\ngot:\n${Out}")
+endif()
+if (NOT Err STREQUAL ExpectedErr)
+    message(FATAL_ERROR "diagnostics differ, expected:\n${ExpectedErr}\ngot:\n${Err}")
+endif()